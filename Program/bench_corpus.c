@@ -0,0 +1,330 @@
+/*
+ * End-to-end benchmark corpus and regression runner
+ * Generates parameterised instance families with fixed seeds, runs logic_solver
+ * on each at increasing sizes and records wall time, peak memory and clause
+ * counts. Results are written as CSV and can be compared against a baseline.
+ *
+ * Build: gcc -O2 bench_corpus.c -o bench_corpus.exe -lpsapi
+ * Usage: bench_corpus [--solver <exe>] [--dir <corpus>] [--timeout <sec>] [--seed <n>]
+ *                     [--family <name>] [--out <file.csv>] [--baseline <file.csv>]
+ *                     [--threshold <percent>] [--keep-going]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <windows.h>
+#include <psapi.h>
+#include "generators.h"
+
+#define MAX_SIZES 16
+#define MAX_RECORDS 256
+#define MAX_PATH_LENGTH 512
+#define MAX_LINE 4096
+#define DEFAULT_TIMEOUT 60.0
+#define DEFAULT_SEED 2025
+#define DEFAULT_THRESHOLD 25.0  // Percent growth of time or memory reported as a regression
+#define TIME_NOISE_MS 20.0      // Differences below this are never regressions
+#define RSS_NOISE_KB 1024.0
+#define PHASE_TRANSITION_RATIO 4.26
+
+// A parameterised instance family
+typedef struct {
+    const char *name;
+    const char *description;
+    FamilyGenerator generate;
+    bool expect_unsat;          // Every member is unsatisfiable
+    int sizes[MAX_SIZES];
+    int num_sizes;
+} Family;
+
+// One solver run
+typedef struct {
+    char family[32];
+    int size;
+    int variables;
+    int clauses;
+    char result[16];
+    double wall_ms;
+    double peak_rss_kb;
+    long long max_clauses;      // Peak working-set size reported by --stats
+    long long kept;             // Resolvents kept, reported by --stats
+} RunRecord;
+
+static RunRecord records[MAX_RECORDS];
+static int num_records = 0;
+
+static Family families[] = {
+    {"random3sat", "uniform random 3-SAT at m/n = 4.26", generate_random_ksat, false,
+     {4, 6, 8, 10, 12, 14, 16, 20, 24, 28, 32, 40, 48, 64}, 14},
+    {"pigeonhole", "PHP(n+1, n)", generate_pigeonhole, true,
+     {1, 2, 3, 4, 5, 6, 7, 8}, 8},
+    {"coloring", "k-colouring of the (k+1)-clique", generate_coloring, true,
+     {2, 3, 4, 5, 6, 7, 8}, 7},
+    {"parity", "two disagreeing parity chains", generate_parity, true,
+     {2, 3, 4, 5, 6, 8, 10, 12, 16}, 9},
+};
+#define NUM_FAMILIES ((int)(sizeof(families) / sizeof(families[0])))
+
+// Function to read a high resolution clock in milliseconds
+static double now_ms(void) {
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+}
+
+// Function to extract an integer field from the --stats JSON line
+static long long json_field(const char *json, const char *field) {
+    char key[64];
+    snprintf(key, sizeof(key), "\"%s\": ", field);
+    const char *found = strstr(json, key);
+    return found ? atoll(found + strlen(key)) : -1;
+}
+
+// Function to run the solver on one file and fill in the measurements
+static bool run_solver(const char *solver, const char *cnf_path, const char *dir, double timeout,
+                       RunRecord *record) {
+    char out_path[MAX_PATH_LENGTH], err_path[MAX_PATH_LENGTH], command[3 * MAX_PATH_LENGTH];
+    snprintf(out_path, sizeof(out_path), "%s/solver_stdout.txt", dir);
+    snprintf(err_path, sizeof(err_path), "%s/solver_stderr.txt", dir);
+    snprintf(command, sizeof(command), "\"%s\" --stats --timeout %g \"%s\"", solver, timeout, cnf_path);
+    
+    SECURITY_ATTRIBUTES inherit = {sizeof(SECURITY_ATTRIBUTES), NULL, TRUE};
+    HANDLE out = CreateFile(out_path, GENERIC_WRITE, FILE_SHARE_READ, &inherit, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    HANDLE err = CreateFile(err_path, GENERIC_WRITE, FILE_SHARE_READ, &inherit, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (out == INVALID_HANDLE_VALUE || err == INVALID_HANDLE_VALUE) {
+        printf("Error: Unable to create solver output files in %s\n", dir);
+        return false;
+    }
+    
+    STARTUPINFO startup = {0};
+    PROCESS_INFORMATION process = {0};
+    startup.cb = sizeof(startup);
+    startup.dwFlags = STARTF_USESTDHANDLES;
+    startup.hStdOutput = out;
+    startup.hStdError = err;
+    
+    double start = now_ms();
+    if (!CreateProcess(NULL, command, NULL, NULL, TRUE, 0, NULL, NULL, &startup, &process)) {
+        printf("Error: Unable to run %s\n", solver);
+        CloseHandle(out);
+        CloseHandle(err);
+        return false;
+    }
+    WaitForSingleObject(process.hProcess, INFINITE);
+    record->wall_ms = now_ms() - start;
+    
+    PROCESS_MEMORY_COUNTERS memory = {0};
+    memory.cb = sizeof(memory);
+    record->peak_rss_kb = GetProcessMemoryInfo(process.hProcess, &memory, sizeof(memory))
+                          ? memory.PeakWorkingSetSize / 1024.0 : 0.0;
+    DWORD exit_code = 0;
+    GetExitCodeProcess(process.hProcess, &exit_code);
+    CloseHandle(process.hProcess);
+    CloseHandle(process.hThread);
+    CloseHandle(out);
+    CloseHandle(err);
+    
+    // First line of stdout is the verdict, the last stats line of stderr has the counters
+    char line[MAX_LINE];
+    strcpy(record->result, "ERROR");
+    FILE *file = fopen(out_path, "r");
+    if (file) {
+        if (fgets(line, sizeof(line), file) && exit_code <= 2) {
+            line[strcspn(line, "\r\n")] = '\0';
+            snprintf(record->result, sizeof(record->result), "%.15s", line);
+        }
+        fclose(file);
+    }
+    record->max_clauses = record->kept = -1;
+    file = fopen(err_path, "r");
+    if (file) {
+        while (fgets(line, sizeof(line), file)) {
+            if (strncmp(line, "{\"result\"", 9) == 0) {
+                record->max_clauses = json_field(line, "max_clauses");
+                record->kept = json_field(line, "kept");
+            }
+        }
+        fclose(file);
+    }
+    return true;
+}
+
+// Function to print the scaling curve of one family (bar length grows with log time)
+static void print_curve(Family *family, int first, int last) {
+    printf("\n%s: %s\n", family->name, family->description);
+    printf("%6s %8s %8s %-14s %10s %10s %12s  %s\n", "size", "vars", "clauses", "result",
+           "wall ms", "peak KB", "max clauses", "log2(ms)");
+    for (int i = first; i < last; i++) {
+        RunRecord *r = &records[i];
+        int bar = (int)(log2(r->wall_ms + 1.0) * 2.0);
+        printf("%6d %8d %8d %-14s %10.1f %10.0f %12lld  ", r->size, r->variables, r->clauses,
+               r->result, r->wall_ms, r->peak_rss_kb, r->max_clauses);
+        for (int b = 0; b < bar && b < 60; b++) putchar('#');
+        putchar('\n');
+    }
+}
+
+// Function to write all records as CSV
+static bool save_records(const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (!file) return false;
+    fprintf(file, "family,size,variables,clauses,result,wall_ms,peak_rss_kb,max_clauses,kept\n");
+    for (int i = 0; i < num_records; i++) {
+        RunRecord *r = &records[i];
+        fprintf(file, "%s,%d,%d,%d,%s,%.3f,%.0f,%lld,%lld\n", r->family, r->size, r->variables,
+                r->clauses, r->result, r->wall_ms, r->peak_rss_kb, r->max_clauses, r->kept);
+    }
+    return fclose(file) == 0;
+}
+
+// Function to compare the records with a baseline CSV, returns the number of regressions
+static int compare_with_baseline(const char *filename, double threshold) {
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        printf("Error: Unable to read baseline %s\n", filename);
+        return -1;
+    }
+    
+    char line[MAX_LINE];
+    int regressions = 0;
+    printf("\nComparison with %s (threshold %.0f%%)\n", filename, threshold);
+    while (fgets(line, sizeof(line), file)) {
+        RunRecord base;
+        if (sscanf(line, "%31[^,],%d,%d,%d,%15[^,],%lf,%lf,%lld,%lld", base.family, &base.size,
+                   &base.variables, &base.clauses, base.result, &base.wall_ms, &base.peak_rss_kb,
+                   &base.max_clauses, &base.kept) != 9) {
+            continue;
+        }
+        for (int i = 0; i < num_records; i++) {
+            RunRecord *r = &records[i];
+            if (strcmp(r->family, base.family) != 0 || r->size != base.size) continue;
+            
+            const char *problem = NULL;
+            if (strcmp(r->result, base.result) != 0) {
+                problem = "VERDICT CHANGED";
+            } else if (r->wall_ms > base.wall_ms * (1 + threshold / 100) && r->wall_ms - base.wall_ms > TIME_NOISE_MS) {
+                problem = "SLOWER";
+            } else if (r->peak_rss_kb > base.peak_rss_kb * (1 + threshold / 100) &&
+                       r->peak_rss_kb - base.peak_rss_kb > RSS_NOISE_KB) {
+                problem = "MORE MEMORY";
+            }
+            if (problem) {
+                printf("  %-12s size %-4d %-15s %s -> %s, %.1f -> %.1f ms, %.0f -> %.0f KB\n", r->family,
+                       r->size, problem, base.result, r->result, base.wall_ms, r->wall_ms,
+                       base.peak_rss_kb, r->peak_rss_kb);
+                regressions++;
+            }
+            break;
+        }
+    }
+    fclose(file);
+    printf("%d regression(s)\n", regressions);
+    return regressions;
+}
+
+int main(int argc, char *argv[]) {
+    const char *solver = "logic_solver.exe";
+    const char *dir = "corpus";
+    const char *out_file = "bench_corpus.csv";
+    const char *baseline_file = NULL;
+    const char *only_family = NULL;
+    double timeout = DEFAULT_TIMEOUT;
+    double threshold = DEFAULT_THRESHOLD;
+    uint64_t seed = DEFAULT_SEED;
+    bool keep_going = false;
+    
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--solver") == 0 && has_value) {
+            solver = argv[++i];
+        } else if (strcmp(argv[i], "--dir") == 0 && has_value) {
+            dir = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && has_value) {
+            out_file = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && has_value) {
+            baseline_file = argv[++i];
+        } else if (strcmp(argv[i], "--family") == 0 && has_value) {
+            only_family = argv[++i];
+        } else if (strcmp(argv[i], "--timeout") == 0 && has_value) {
+            timeout = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--threshold") == 0 && has_value) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--keep-going") == 0) {
+            keep_going = true;
+        } else {
+            printf("Usage: %s [--solver <exe>] [--dir <corpus>] [--timeout <sec>] [--seed <n>]\n"
+                   "       [--family <name>] [--out <file.csv>] [--baseline <file.csv>]\n"
+                   "       [--threshold <percent>] [--keep-going]\n", argv[0]);
+            printf("Families:");
+            for (int f = 0; f < NUM_FAMILIES; f++) printf(" %s", families[f].name);
+            printf("\n");
+            return 1;
+        }
+    }
+    CreateDirectory(dir, NULL);
+    
+    int wrong = 0;
+    for (int f = 0; f < NUM_FAMILIES; f++) {
+        Family *family = &families[f];
+        if (only_family && strcmp(only_family, family->name) != 0) continue;
+        
+        int first = num_records;
+        for (int s = 0; s < family->num_sizes && num_records < MAX_RECORDS; s++) {
+            RunRecord *record = &records[num_records];
+            char cnf_path[MAX_PATH_LENGTH];
+            snprintf(cnf_path, sizeof(cnf_path), "%s/%s_%d.cnf", dir, family->name, family->sizes[s]);
+            
+            // The seed is used as given, so input_generator --seed reproduces any file of the corpus
+            FamilyParams params = {family->sizes[s], PHASE_TRANSITION_RATIO, 3, family->sizes[s]};
+            Writer writer;
+            if (!writer_open(&writer, cnf_path, FORMAT_CNF)) {
+                printf("Error: Unable to create %s\n", cnf_path);
+                return 1;
+            }
+            bool generated = family->generate(&writer, &params, seed);
+            if (!writer_close(&writer) || !generated) {
+                printf("Error: Unable to write %s\n", cnf_path);
+                return 1;
+            }
+            snprintf(record->family, sizeof(record->family), "%s", family->name);
+            record->size = family->sizes[s];
+            record->variables = (int)writer.variables;
+            record->clauses = (int)writer.clauses;
+            
+            if (!run_solver(solver, cnf_path, dir, timeout, record)) return 1;
+            num_records++;
+            
+            if (family->expect_unsat && strcmp(record->result, "SATISFIABLE") == 0) {
+                printf("WRONG ANSWER: %s is unsatisfiable but the solver said SATISFIABLE\n", cnf_path);
+                wrong++;
+            }
+            // Larger members only get harder, so stop the curve at the first unfinished run
+            if (!keep_going && strcmp(record->result, "SATISFIABLE") != 0 &&
+                strcmp(record->result, "UNSATISFIABLE") != 0) {
+                break;
+            }
+        }
+        print_curve(family, first, num_records);
+    }
+    
+    if (!save_records(out_file)) {
+        printf("Error: Unable to write %s\n", out_file);
+        return 1;
+    }
+    printf("\nResults written to %s\n", out_file);
+    
+    if (wrong > 0) return 4;
+    if (baseline_file) {
+        int regressions = compare_with_baseline(baseline_file, threshold);
+        if (regressions != 0) return regressions < 0 ? 1 : 3;
+    }
+    return 0;
+}
@@ -0,0 +1,336 @@
+/*
+ * Micro-benchmarks for the core kernels of the logic solver
+ * Times resolve(), clauses_equal(), is_tautology(), clause_contains() and
+ * read_formula_from_file() on reproducible synthetic inputs. Every kernel is
+ * timed in several repetitions and the median time per call is reported.
+ *
+ * Build: gcc -O2 bench_kernels.c -o bench_kernels.exe
+ * Usage: bench_kernels [--save <file.json>] [--baseline <file.json>] [--threshold <percent>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <windows.h>
+
+// Count every heap allocation made by the solver code included below
+static long long allocation_count = 0;
+
+static void *counting_malloc(size_t size) {
+    allocation_count++;
+    return malloc(size);
+}
+
+static void *counting_calloc(size_t count, size_t size) {
+    allocation_count++;
+    return calloc(count, size);
+}
+
+static void *counting_realloc(void *ptr, size_t size) {
+    allocation_count++;
+    return realloc(ptr, size);
+}
+
+#define malloc(size) counting_malloc(size)
+#define calloc(count, size) counting_calloc(count, size)
+#define realloc(ptr, size) counting_realloc(ptr, size)
+#define LOGIC_SOLVER_NO_MAIN
+#include "logic_solver.c"
+#undef malloc
+#undef calloc
+#undef realloc
+#include "generators.h"
+
+#define MAX_RESULTS 128
+#define MIN_BENCH_TIME 0.2      // Seconds each repetition of a kernel runs for at least
+#define MIN_KERNEL_OPS 100000   // Calls each repetition of a clause kernel makes at least
+#define MIN_PARSE_OPS 20        // Parses each repetition of the parser makes at least
+#define BENCH_REPETITIONS 5     // Repetitions of every kernel, the median time is reported
+#define DEFAULT_THRESHOLD 10.0  // Percent slowdown reported as a regression
+#define PARSER_CLAUSES 20000
+#define BENCH_SEED 0x2545F4914F6CDD1DULL
+
+// One measured kernel configuration
+typedef struct {
+    char name[64];
+    double ns_per_op;
+    double allocs_per_op;
+    double literals_per_sec;
+} BenchResult;
+
+static BenchResult results[MAX_RESULTS];
+static int num_results = 0;
+static volatile long long bench_sink = 0;  // Keeps the compiler from dropping kernel calls
+
+static const int widths[] = {2, 4, 8, 16, 32};
+static const int var_counts[] = {16, 256, 4096};
+
+// Function to build a non-tautological clause of the given width over num_vars variables
+static void random_clause(Clause *clause, int width, int num_vars, uint64_t *state) {
+    char name[MAX_VAR_NAME];
+    if (width > num_vars) width = num_vars;
+    init_clause(clause);
+    while (clause->num_literals < width) {
+        sprintf(name, "X_%d", (int)(next_random(state) % num_vars));
+        if (clause_contains(clause, name, false) || clause_contains(clause, name, true)) {
+            continue;
+        }
+        add_literal(clause, name, next_random(state) & 1);
+    }
+}
+
+// Function to tell whether a repetition has run long enough
+// Both limits must be met, so a slow kernel gets as much time as its minimum number of calls needs
+static bool repetition_done(long long ops, double elapsed, long long min_ops) {
+    return ops >= min_ops && elapsed >= MIN_BENCH_TIME;
+}
+
+// Function to find the median of the repetitions (sorts the values)
+static double median(double *values, int count) {
+    for (int i = 1; i < count; i++) {
+        double value = values[i];
+        int j = i;
+        for (; j > 0 && values[j - 1] > value; j--) values[j] = values[j - 1];
+        values[j] = value;
+    }
+    return count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2;
+}
+
+// Function to record a result and print it as a table row
+// The time per call is the median of the repetitions; allocations and literals are averaged over all calls
+static void record_result(const char *name, double *seconds_per_op, long long ops, long long allocations,
+                          long long literals) {
+    if (num_results >= MAX_RESULTS) return;
+    BenchResult *result = &results[num_results++];
+    double seconds = median(seconds_per_op, BENCH_REPETITIONS);
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->ns_per_op = seconds * 1e9;
+    result->allocs_per_op = (double)allocations / ops;
+    result->literals_per_sec = (double)literals / ops / seconds;
+    printf("%-28s %12.1f ns/op %8.2f allocs/op %14.0f lits/s\n",
+           result->name, result->ns_per_op, result->allocs_per_op, result->literals_per_sec);
+}
+
+// Function to time the clause kernels for one width and variable count
+static void bench_clause_kernels(int width, int num_vars) {
+    uint64_t state = BENCH_SEED ^ ((uint64_t)width << 32) ^ (uint64_t)num_vars;
+    Clause a, b, a_copy, absent;
+    char name[64];
+    
+    // Two clauses clashing on their first literal, and a permuted copy of the first
+    random_clause(&a, width, num_vars, &state);
+    random_clause(&b, width, num_vars, &state);
+    for (int i = 1; i < b.num_literals; i++) {
+        if (strcmp(b.literals[i].var.name, a.literals[0].var.name) == 0) {
+            b.literals[i].var.name[0] = 'Y';
+        }
+    }
+    strcpy(b.literals[0].var.name, a.literals[0].var.name);
+    b.literals[0].is_negated = !a.literals[0].is_negated;
+    copy_clause(&a_copy, &a);
+    for (int i = a_copy.num_literals - 1; i > 0; i--) {
+        int j = (int)(next_random(&state) % (i + 1));
+        Literal tmp = a_copy.literals[i];
+        a_copy.literals[i] = a_copy.literals[j];
+        a_copy.literals[j] = tmp;
+    }
+    init_clause(&absent);
+    add_literal(&absent, "Z_absent", false);
+    
+    for (int kernel = 0; kernel < 4; kernel++) {
+        double seconds_per_op[BENCH_REPETITIONS];
+        long long total_ops = 0, literals = 0;
+        long long allocations_before = allocation_count;
+        for (int repetition = 0; repetition < BENCH_REPETITIONS; repetition++) {
+            long long ops = 0;
+            double start = now_seconds(), elapsed;
+            do {
+                for (int rep = 0; rep < 256; rep++) {
+                    Clause result;
+                    switch (kernel) {
+                        case 0:
+                            bench_sink += resolve(&a, &b, a.literals[0].var.name, a.literals[0].is_negated, &result);
+                            free_clause(&result);
+                            literals += a.num_literals + b.num_literals;
+                            break;
+                        case 1:
+                            bench_sink += clauses_equal(&a, &a_copy);
+                            literals += a.num_literals + a_copy.num_literals;
+                            break;
+                        case 2:
+                            bench_sink += is_tautology(&a);
+                            literals += a.num_literals;
+                            break;
+                        default:
+                            bench_sink += clause_contains(&a, absent.literals[0].var.name, false);
+                            literals += a.num_literals;
+                            break;
+                    }
+                }
+                ops += 256;
+                elapsed = now_seconds() - start;
+            } while (!repetition_done(ops, elapsed, MIN_KERNEL_OPS));
+            seconds_per_op[repetition] = elapsed / ops;
+            total_ops += ops;
+        }
+        
+        static const char *kernel_names[] = {"resolve", "clauses_equal", "is_tautology", "clause_contains"};
+        snprintf(name, sizeof(name), "%s/w%d/v%d", kernel_names[kernel], width, num_vars);
+        record_result(name, seconds_per_op, total_ops, allocation_count - allocations_before, literals);
+    }
+    
+    free_clause(&a);
+    free_clause(&b);
+    free_clause(&a_copy);
+    free_clause(&absent);
+}
+
+// Function to time the parser on a generated file
+static bool bench_parser(int width, int num_vars) {
+    uint64_t state = BENCH_SEED ^ 0xF11EULL ^ ((uint64_t)width << 32) ^ (uint64_t)num_vars;
+    const char *filename = "bench_kernels_tmp.cnf";
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        printf("Error: Unable to create %s\n", filename);
+        return false;
+    }
+    long long literals_per_parse = 0;
+    for (int i = 0; i < PARSER_CLAUSES; i++) {
+        Clause clause;
+        random_clause(&clause, width, num_vars, &state);
+        for (int k = 0; k < clause.num_literals; k++) {
+            fprintf(file, "%s%s%s", k ? " " : "", clause.literals[k].is_negated ? "!" : "",
+                    clause.literals[k].var.name);
+        }
+        fprintf(file, "\n");
+        literals_per_parse += clause.num_literals;
+        free_clause(&clause);
+    }
+    fclose(file);
+    
+    double seconds_per_op[BENCH_REPETITIONS];
+    long long total_ops = 0;
+    long long allocations_before = allocation_count;
+    for (int repetition = 0; repetition < BENCH_REPETITIONS; repetition++) {
+        long long ops = 0;
+        double start = now_seconds(), elapsed;
+        do {
+            Formula formula;
+            if (!read_formula_from_file(filename, &formula)) {
+                remove(filename);
+                return false;
+            }
+            bench_sink += formula.num_clauses;
+            free_formula(&formula);
+            ops++;
+            elapsed = now_seconds() - start;
+        } while (!repetition_done(ops, elapsed, MIN_PARSE_OPS));
+        seconds_per_op[repetition] = elapsed / ops;
+        total_ops += ops;
+    }
+    remove(filename);
+    
+    char name[64];
+    snprintf(name, sizeof(name), "parse/w%d/v%d", width, num_vars);
+    record_result(name, seconds_per_op, total_ops, allocation_count - allocations_before,
+                  literals_per_parse * total_ops);
+    return true;
+}
+
+// Function to save the results as JSON
+static bool save_results(const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (!file) return false;
+    fprintf(file, "{\"benchmarks\": [\n");
+    for (int i = 0; i < num_results; i++) {
+        fprintf(file, "  {\"name\": \"%s\", \"ns_per_op\": %.3f, \"allocs_per_op\": %.3f, "
+                "\"literals_per_sec\": %.1f}%s\n", results[i].name, results[i].ns_per_op,
+                results[i].allocs_per_op, results[i].literals_per_sec, i + 1 < num_results ? "," : "");
+    }
+    fprintf(file, "]}\n");
+    return fclose(file) == 0;
+}
+
+// Function to load a JSON file written by save_results
+static int load_results(const char *filename, BenchResult *loaded, int max_results) {
+    FILE *file = fopen(filename, "r");
+    if (!file) return -1;
+    char line[MAX_LINE_LENGTH];
+    int count = 0;
+    while (fgets(line, sizeof(line), file) && count < max_results) {
+        BenchResult *result = &loaded[count];
+        if (sscanf(line, " {\"name\": \"%63[^\"]\", \"ns_per_op\": %lf, \"allocs_per_op\": %lf, "
+                   "\"literals_per_sec\": %lf", result->name, &result->ns_per_op,
+                   &result->allocs_per_op, &result->literals_per_sec) == 4) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+// Function to compare the results with a baseline, returns the number of regressions
+static int compare_with_baseline(const char *filename, double threshold) {
+    static BenchResult baseline[MAX_RESULTS];
+    int count = load_results(filename, baseline, MAX_RESULTS);
+    if (count < 0) {
+        printf("Error: Unable to read baseline %s\n", filename);
+        return -1;
+    }
+    
+    int regressions = 0;
+    printf("\n%-28s %12s %12s %9s %14s\n", "kernel", "baseline ns", "current ns", "change", "allocs/op");
+    for (int i = 0; i < num_results; i++) {
+        for (int j = 0; j < count; j++) {
+            if (strcmp(results[i].name, baseline[j].name) != 0) continue;
+            double change = (results[i].ns_per_op / baseline[j].ns_per_op - 1.0) * 100.0;
+            bool regressed = change > threshold || results[i].allocs_per_op > baseline[j].allocs_per_op + 0.01;
+            printf("%-28s %12.1f %12.1f %+8.1f%% %6.2f -> %-5.2f%s\n", results[i].name,
+                   baseline[j].ns_per_op, results[i].ns_per_op, change, baseline[j].allocs_per_op,
+                   results[i].allocs_per_op, regressed ? "  REGRESSION" : change < -threshold ? "  improved" : "");
+            if (regressed) regressions++;
+            break;
+        }
+    }
+    printf("\n%d regression(s) beyond %.1f%%\n", regressions, threshold);
+    return regressions;
+}
+
+int main(int argc, char *argv[]) {
+    const char *save_file = NULL;
+    const char *baseline_file = NULL;
+    double threshold = DEFAULT_THRESHOLD;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            save_file = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_file = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else {
+            printf("Usage: %s [--save <file.json>] [--baseline <file.json>] [--threshold <percent>]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    for (size_t v = 0; v < sizeof(var_counts) / sizeof(var_counts[0]); v++) {
+        for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+            bench_clause_kernels(widths[w], var_counts[v]);
+        }
+    }
+    for (size_t v = 0; v < sizeof(var_counts) / sizeof(var_counts[0]); v++) {
+        if (!bench_parser(8, var_counts[v])) return 1;
+    }
+    
+    if (save_file && !save_results(save_file)) {
+        printf("Error: Unable to write %s\n", save_file);
+        return 1;
+    }
+    if (baseline_file) {
+        int regressions = compare_with_baseline(baseline_file, threshold);
+        if (regressions != 0) return regressions < 0 ? 1 : 3;
+    }
+    return 0;
+}
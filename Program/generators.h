@@ -0,0 +1,258 @@
+/*
+ * Instance generation shared by input_generator, bench_corpus and bench_kernels
+ * Included by each program (they are built as single files), so a family, size
+ * and seed give the same instance whichever tool writes it. Output goes through
+ * a large buffer with hand-rolled number formatting, in the solver's own format
+ * or in DIMACS.
+ */
+
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#define WRITER_BUFFER_SIZE (4 * 1024 * 1024)
+
+typedef enum { FORMAT_CNF, FORMAT_DIMACS } OutputFormat;
+
+// Parameters of one instance
+typedef struct {
+    int vars;            // random-ksat: number of variables
+    double ratio;        // random-ksat: clauses per variable
+    int k;               // random-ksat: literals per clause
+    int size;            // pigeonhole holes, coloring colours, parity chain length
+} FamilyParams;
+
+// Buffered output file
+typedef struct {
+    FILE *file;
+    char *buffer;
+    size_t used;
+    bool failed;
+    OutputFormat format;
+    long long variables;  // Declared by writer_header
+    long long clauses;    // Clauses ended so far
+} Writer;
+
+// Function to open a buffered writer
+bool writer_open(Writer *writer, const char *filename, OutputFormat format) {
+    writer->file = fopen(filename, "wb");
+    writer->buffer = malloc(WRITER_BUFFER_SIZE);
+    writer->used = 0;
+    writer->failed = false;
+    writer->format = format;
+    writer->variables = writer->clauses = 0;
+    if (!writer->file || !writer->buffer) {
+        if (writer->file) fclose(writer->file);
+        free(writer->buffer);
+        return false;
+    }
+    return true;
+}
+
+// Function to write the buffered bytes to the file
+void writer_flush(Writer *writer) {
+    if (writer->used > 0 && fwrite(writer->buffer, 1, writer->used, writer->file) != writer->used) {
+        writer->failed = true;
+    }
+    writer->used = 0;
+}
+
+// Function to close a writer, returns false if any write failed
+bool writer_close(Writer *writer) {
+    writer_flush(writer);
+    if (fclose(writer->file) != 0) writer->failed = true;
+    free(writer->buffer);
+    return !writer->failed;
+}
+
+// Function to append a string
+void writer_put_string(Writer *writer, const char *text) {
+    size_t length = strlen(text);
+    if (writer->used + length > WRITER_BUFFER_SIZE) writer_flush(writer);
+    memcpy(writer->buffer + writer->used, text, length);
+    writer->used += length;
+}
+
+// Function to append a non-negative integer without going through printf
+void writer_put_number(Writer *writer, long long value) {
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    if (writer->used + count + 1 > WRITER_BUFFER_SIZE) writer_flush(writer);
+    while (count > 0) writer->buffer[writer->used++] = digits[--count];
+}
+
+// Function to append one literal: prefix_a[_b] in CNF format, +-id in DIMACS format
+void writer_put_literal(Writer *writer, bool negated, long long id, const char *prefix, int a, int b) {
+    if (writer->used + 96 > WRITER_BUFFER_SIZE) writer_flush(writer);
+    if (negated) writer->buffer[writer->used++] = writer->format == FORMAT_DIMACS ? '-' : '!';
+    if (writer->format == FORMAT_DIMACS) {
+        writer_put_number(writer, id);
+    } else {
+        writer_put_string(writer, prefix);
+        writer->buffer[writer->used++] = '_';
+        writer_put_number(writer, a);
+        if (b >= 0) {
+            writer->buffer[writer->used++] = '_';
+            writer_put_number(writer, b);
+        }
+    }
+    writer->buffer[writer->used++] = ' ';
+}
+
+// Function to terminate the current clause
+void writer_end_clause(Writer *writer) {
+    if (writer->used + 3 > WRITER_BUFFER_SIZE) writer_flush(writer);
+    if (writer->format == FORMAT_DIMACS) {
+        writer->buffer[writer->used++] = '0';
+    } else if (writer->used > 0 && writer->buffer[writer->used - 1] == ' ') {
+        writer->used--;
+    }
+    writer->buffer[writer->used++] = '\n';
+    writer->clauses++;
+}
+
+// Function to write the file header (comment line, and the problem line for DIMACS)
+void writer_header(Writer *writer, const char *description, long long vars, long long clauses) {
+    writer->variables = vars;
+    writer_put_string(writer, writer->format == FORMAT_DIMACS ? "c " : "# ");
+    writer_put_string(writer, description);
+    writer_put_string(writer, "\n");
+    if (writer->format == FORMAT_DIMACS) {
+        writer_put_string(writer, "p cnf ");
+        writer_put_number(writer, vars);
+        writer_put_string(writer, " ");
+        writer_put_number(writer, clauses);
+        writer_put_string(writer, "\n");
+    }
+}
+
+// Function to draw the next value of a xorshift64* generator
+uint64_t next_random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// Uniform random k-SAT: every clause has k distinct variables with random signs
+bool generate_random_ksat(Writer *writer, FamilyParams *params, uint64_t seed) {
+    uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    long long clauses = llround(params->ratio * params->vars);
+    int vars[64];
+    char description[96];
+    snprintf(description, sizeof(description), "Uniform random %d-SAT, %d variables, seed %llu", params->k,
+             params->vars, (unsigned long long)seed);
+    writer_header(writer, description, params->vars, clauses);
+    for (long long i = 0; i < clauses; i++) {
+        for (int j = 0; j < params->k; j++) {
+            bool repeated;
+            do {
+                vars[j] = (int)(next_random(&state) % (uint64_t)params->vars) + 1;
+                repeated = false;
+                for (int m = 0; m < j; m++) repeated |= vars[m] == vars[j];
+            } while (repeated);
+            writer_put_literal(writer, next_random(&state) >> 63, vars[j], "X", vars[j], -1);
+        }
+        writer_end_clause(writer);
+    }
+    return true;
+}
+
+// Pigeonhole PHP(n+1, n): P_i_j means pigeon i sits in hole j
+bool generate_pigeonhole(Writer *writer, FamilyParams *params, uint64_t seed) {
+    (void)seed;
+    long long holes = params->size, pigeons = holes + 1;
+    char description[96];
+    snprintf(description, sizeof(description), "Pigeonhole principle, %lld pigeons in %lld holes", pigeons, holes);
+    writer_header(writer, description, pigeons * holes,
+                  pigeons + holes * pigeons * (pigeons - 1) / 2);
+    for (int i = 1; i <= pigeons; i++) {
+        for (int j = 1; j <= holes; j++) writer_put_literal(writer, false, (i - 1) * holes + j, "P", i, j);
+        writer_end_clause(writer);
+    }
+    for (int j = 1; j <= holes; j++) {
+        for (int i = 1; i <= pigeons; i++) {
+            for (int m = i + 1; m <= pigeons; m++) {
+                writer_put_literal(writer, true, (i - 1) * holes + j, "P", i, j);
+                writer_put_literal(writer, true, (m - 1) * holes + j, "P", m, j);
+                writer_end_clause(writer);
+            }
+        }
+    }
+    return true;
+}
+
+// Colouring the complete graph on k+1 vertices with k colours: P_v_c means vertex v has colour c
+bool generate_coloring(Writer *writer, FamilyParams *params, uint64_t seed) {
+    (void)seed;
+    long long colors = params->size, vertices = colors + 1;
+    char description[96];
+    snprintf(description, sizeof(description), "%lld-colouring of the complete graph on %lld vertices", colors,
+             vertices);
+    writer_header(writer, description, vertices * colors,
+                  vertices + colors * vertices * (vertices - 1) / 2);
+    for (int v = 1; v <= vertices; v++) {
+        for (int c = 1; c <= colors; c++) writer_put_literal(writer, false, (v - 1) * colors + c, "P", v, c);
+        writer_end_clause(writer);
+    }
+    for (int c = 1; c <= colors; c++) {
+        for (int v = 1; v <= vertices; v++) {
+            for (int w = v + 1; w <= vertices; w++) {
+                writer_put_literal(writer, true, (v - 1) * colors + c, "P", v, c);
+                writer_put_literal(writer, true, (w - 1) * colors + c, "P", w, c);
+                writer_end_clause(writer);
+            }
+        }
+    }
+    return true;
+}
+
+// Two XOR chains over X_1..X_n in opposite orders whose outputs must differ (unsatisfiable)
+bool generate_parity(Writer *writer, FamilyParams *params, uint64_t seed) {
+    (void)seed;
+    long long n = params->size;
+    if (n < 2) return false;
+    char description[96];
+    snprintf(description, sizeof(description), "Parity of %lld variables computed by two chains that must disagree", n);
+    writer_header(writer, description, n + 2 * (n - 1),
+                  2 * (4 * (n - 1) + 1));
+    for (int chain = 0; chain < 2; chain++) {
+        const char *prefix = chain == 0 ? "T" : "U";
+        long long base = n + chain * (n - 1);   // DIMACS id of the chain output for i = 2 is base + 1
+        const char *prev_prefix = "X";
+        long long prev_index = chain == 0 ? 1 : n, prev_id = prev_index;
+        for (long long i = 2; i <= n; i++) {
+            long long input = chain == 0 ? i : n + 1 - i, out_id = base + i - 1;
+            // out = prev XOR input
+            for (int signs = 0; signs < 4; signs++) {
+                bool neg_prev = signs & 1, neg_input = (signs >> 1) & 1;
+                bool neg_out = !(neg_prev ^ neg_input);
+                writer_put_literal(writer, neg_out, out_id, prefix, (int)i, -1);
+                writer_put_literal(writer, neg_prev, prev_id, prev_prefix, (int)prev_index, -1);
+                writer_put_literal(writer, neg_input, input, "X", (int)input, -1);
+                writer_end_clause(writer);
+            }
+            prev_prefix = prefix;
+            prev_index = i;
+            prev_id = out_id;
+        }
+        writer_put_literal(writer, chain == 1, prev_id, prev_prefix, (int)prev_index, -1);
+        writer_end_clause(writer);
+    }
+    return true;
+}
+
+// Generator of one family, returns false when the parameters do not describe an instance
+typedef bool (*FamilyGenerator)(Writer *writer, FamilyParams *params, uint64_t seed);
+
+#endif
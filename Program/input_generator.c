@@ -1,8 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
 #include <windows.h>
 #include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include "generators.h"
 
 #define MAX_LINE 1024
 #define COLOR_CYAN 11
@@ -304,7 +310,230 @@ void show_formulas() {
     }
 }
 
-int main() {
+/*
+ * Non-interactive generation mode
+ * input_generator --family random-ksat --vars 100000 --ratio 4.2 --seed 7 -o f.cnf
+ * The families and the buffered writer live in generators.h, which bench_corpus
+ * shares, so generation runs at disk speed and both tools write the same
+ * instance for a seed. Shard sets are generated by a pool of threads, each
+ * shard with its own seed.
+ */
+
+#define MAX_THREADS 64
+#define MAX_FAMILY_SIZE 10000000
+#define MAX_SHARDS 1000000
+#define MAX_RATIO 1000000.0
+
+typedef struct {
+    const char *family;
+    FamilyParams params;
+    uint64_t seed;
+    OutputFormat format;
+    const char *output;
+    int shards;
+    int threads;
+} GeneratorOptions;
+
+typedef struct {
+    const char *name;
+    FamilyGenerator generate;
+} FamilyEntry;
+
+static FamilyEntry family_table[] = {
+    {"random-ksat", generate_random_ksat},
+    {"pigeonhole", generate_pigeonhole},
+    {"coloring", generate_coloring},
+    {"parity", generate_parity},
+};
+#define NUM_FAMILY_ENTRIES ((int)(sizeof(family_table) / sizeof(family_table[0])))
+
+// Shared state of the shard workers
+typedef struct {
+    GeneratorOptions *options;
+    FamilyGenerator generate;
+    volatile LONG next_shard;
+    volatile LONG failures;
+} ShardJob;
+
+// Function to build the file name of a shard: f.cnf -> f_0007.cnf
+void shard_filename(const char *output, int shard, int shards, char *name, size_t size) {
+    if (shards <= 1) {
+        snprintf(name, size, "%s", output);
+        return;
+    }
+    const char *dot = strrchr(output, '.');
+    int stem = dot ? (int)(dot - output) : (int)strlen(output);
+    snprintf(name, size, "%.*s_%04d%s", stem, output, shard, dot ? dot : "");
+}
+
+// Function run by each worker thread: claims shards until none are left
+DWORD WINAPI shard_worker(void *param) {
+    ShardJob *job = param;
+    char filename[MAX_PATH];
+    for (;;) {
+        int shard = (int)InterlockedIncrement(&job->next_shard) - 1;
+        if (shard >= job->options->shards) break;
+        shard_filename(job->options->output, shard, job->options->shards, filename, sizeof(filename));
+        
+        Writer writer;
+        if (!writer_open(&writer, filename, job->options->format)) {
+            InterlockedIncrement(&job->failures);
+            continue;
+        }
+        bool generated = job->generate(&writer, &job->options->params, job->options->seed + (uint64_t)shard);
+        if (!writer_close(&writer) || !generated) {
+            InterlockedIncrement(&job->failures);
+        }
+    }
+    return 0;
+}
+
+// Function to parse an integer option value, fails unless it is a whole number in [min, max]
+bool parse_int_option(const char *option, const char *text, long min, long max, int *value) {
+    char *end;
+    errno = 0;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < min || parsed > max) {
+        printf("Error: %s expects an integer from %ld to %ld, got %s\n", option, min, max, text);
+        return false;
+    }
+    *value = (int)parsed;
+    return true;
+}
+
+// Function to parse a real option value, fails unless it is a number in [min, max]
+bool parse_real_option(const char *option, const char *text, double min, double max, double *value) {
+    char *end;
+    errno = 0;
+    double parsed = strtod(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !(parsed >= min && parsed <= max)) {
+        printf("Error: %s expects a number from %g to %g, got %s\n", option, min, max, text);
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+// Function to parse the seed, fails unless it is a whole number that fits in 64 bits
+bool parse_seed_option(const char *text, uint64_t *value) {
+    char *end;
+    errno = 0;
+    unsigned long long parsed = strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || text[strspn(text, " \t")] == '-') {
+        printf("Error: --seed expects a non-negative integer, got %s\n", text);
+        return false;
+    }
+    *value = (uint64_t)parsed;
+    return true;
+}
+
+void print_generator_usage(const char *program) {
+    printf("Usage: %s --family <name> [options] -o <file>\n", program);
+    printf("Families:\n");
+    printf("  random-ksat   --vars <n> [--ratio <m/n>] [--k <width>]\n");
+    printf("  pigeonhole    --size <holes>\n");
+    printf("  coloring      --size <colours>   (complete graph on size+1 vertices)\n");
+    printf("  parity        --size <n>         (two disagreeing XOR chains)\n");
+    printf("Options:\n");
+    printf("  --seed <n>          Random seed, shard i uses seed + i (default 1)\n");
+    printf("  --format cnf|dimacs Output format (default cnf, the solver's own format)\n");
+    printf("  --shards <n>        Write n instances named <file>_0000.<ext>, ...\n");
+    printf("  --threads <n>       Generate shards on n threads (default: number of processors)\n");
+}
+
+// Function to run the non-interactive generator, returns the process exit code
+int run_generator(int argc, char *argv[]) {
+    GeneratorOptions options = {NULL, {0, 4.26, 3, 0}, 1, FORMAT_CNF, NULL, 1, 0};
+    
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        bool parsed = true;
+        if (strcmp(argv[i], "--family") == 0 && has_value) {
+            options.family = argv[++i];
+        } else if (strcmp(argv[i], "--vars") == 0 && has_value) {
+            parsed = parse_int_option(argv[i], argv[i + 1], 1, INT_MAX, &options.params.vars);
+            i++;
+        } else if (strcmp(argv[i], "--ratio") == 0 && has_value) {
+            parsed = parse_real_option(argv[i], argv[i + 1], 0.0, MAX_RATIO, &options.params.ratio);
+            i++;
+        } else if (strcmp(argv[i], "--k") == 0 && has_value) {
+            parsed = parse_int_option(argv[i], argv[i + 1], 1, 64, &options.params.k);
+            i++;
+        } else if (strcmp(argv[i], "--size") == 0 && has_value) {
+            parsed = parse_int_option(argv[i], argv[i + 1], 1, MAX_FAMILY_SIZE, &options.params.size);
+            i++;
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            parsed = parse_seed_option(argv[i + 1], &options.seed);
+            i++;
+        } else if (strcmp(argv[i], "--shards") == 0 && has_value) {
+            parsed = parse_int_option(argv[i], argv[i + 1], 1, MAX_SHARDS, &options.shards);
+            i++;
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            parsed = parse_int_option(argv[i], argv[i + 1], 0, INT_MAX, &options.threads);
+            i++;
+        } else if (strcmp(argv[i], "--format") == 0 && has_value) {
+            i++;
+            if (strcmp(argv[i], "dimacs") == 0) {
+                options.format = FORMAT_DIMACS;
+            } else if (strcmp(argv[i], "cnf") != 0) {
+                printf("Error: Unknown format %s\n", argv[i]);
+                return 1;
+            }
+        } else if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && has_value) {
+            options.output = argv[++i];
+        } else {
+            print_generator_usage(argv[0]);
+            return 1;
+        }
+        if (!parsed) return 1;
+    }
+    
+    FamilyGenerator generate = NULL;
+    for (int f = 0; options.family && f < NUM_FAMILY_ENTRIES; f++) {
+        if (strcmp(options.family, family_table[f].name) == 0) generate = family_table[f].generate;
+    }
+    bool valid = generate && options.output && options.shards >= 1;
+    if (generate == generate_random_ksat) {
+        valid = valid && options.params.vars > 0 && options.params.k <= options.params.vars;
+    } else if (generate) {
+        valid = valid && options.params.size >= (generate == generate_parity ? 2 : 1);
+    }
+    if (!valid) {
+        print_generator_usage(argv[0]);
+        return 1;
+    }
+    
+    if (options.threads <= 0) {
+        SYSTEM_INFO system_info;
+        GetSystemInfo(&system_info);
+        options.threads = (int)system_info.dwNumberOfProcessors;
+    }
+    if (options.threads > options.shards) options.threads = options.shards;
+    if (options.threads > MAX_THREADS) options.threads = MAX_THREADS;
+    
+    ShardJob job = {&options, generate, 0, 0};
+    HANDLE threads[MAX_THREADS];
+    int started = 0;
+    for (int t = 1; t < options.threads; t++) {
+        threads[started] = CreateThread(NULL, 0, shard_worker, &job, 0, NULL);
+        if (threads[started]) started++;
+    }
+    shard_worker(&job);
+    if (started > 0) WaitForMultipleObjects(started, threads, TRUE, INFINITE);
+    for (int t = 0; t < started; t++) CloseHandle(threads[t]);
+    
+    if (job.failures > 0) {
+        printf("Error: %ld of %d instance(s) could not be written\n", (long)job.failures, options.shards);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        return run_generator(argc, argv);
+    }
+    
     SetConsoleOutputCP(CP_UTF8);
     char choice;
 
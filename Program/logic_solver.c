@@ -8,6 +8,9 @@
 #include <string.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
 #include <windows.h>
 
 // Color definitions for Windows
@@ -70,6 +73,7 @@ typedef struct {
     Literal *literals;
     int num_literals;
     int capacity;
+    int parents[2];  // Working set ids (index + 1) of the clauses resolved into this one, 0 for inputs
 } Clause;
 
 // Structure to represent a formula (conjunction of clauses)
@@ -80,6 +84,8 @@ typedef struct {
     Variable *variables;  // Track unique variables
     int num_variables;
     int var_capacity;
+    int *var_index;       // Open-addressing hash over variables (slot = id + 1, 0 = empty)
+    int var_index_capacity;
 } Formula;
 
 // Function to initialize a variable
@@ -98,6 +104,8 @@ bool init_clause(Clause *clause) {
     if (!clause->literals) return false;
     clause->num_literals = 0;
     clause->capacity = INITIAL_CAPACITY;
+    clause->parents[0] = 0;
+    clause->parents[1] = 0;
     return true;
 }
 
@@ -111,17 +119,21 @@ void free_clause(Clause *clause) {
 
 // Function to initialize a formula
 bool init_formula(Formula *formula) {
+    int index_capacity = 256;  // Power of two, kept at least twice the variable count
     formula->clauses = malloc(INITIAL_CAPACITY * sizeof(Clause));
     formula->variables = malloc(INITIAL_CAPACITY * sizeof(Variable));
-    if (!formula->clauses || !formula->variables) {
+    formula->var_index = calloc(index_capacity, sizeof(int));
+    if (!formula->clauses || !formula->variables || !formula->var_index) {
         free(formula->clauses);
         free(formula->variables);
+        free(formula->var_index);
         return false;
     }
     formula->num_clauses = 0;
     formula->capacity = INITIAL_CAPACITY;
     formula->num_variables = 0;
     formula->var_capacity = INITIAL_CAPACITY;
+    formula->var_index_capacity = index_capacity;
     return true;
 }
 
@@ -132,21 +144,63 @@ void free_formula(Formula *formula) {
     }
     free(formula->clauses);
     free(formula->variables);
+    free(formula->var_index);
     formula->clauses = NULL;
     formula->variables = NULL;
+    formula->var_index = NULL;
     formula->num_clauses = 0;
     formula->capacity = 0;
     formula->num_variables = 0;
     formula->var_capacity = 0;
+    formula->var_index_capacity = 0;
+}
+
+// Function to hash a variable name (FNV-1a)
+uint32_t hash_name(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Function to locate the index slot of a variable name (either its slot or the empty one to use)
+static int variable_slot(Formula *formula, const char *name) {
+    int mask = formula->var_index_capacity - 1;
+    int slot = (int)(hash_name(name) & (uint32_t)mask);
+    while (formula->var_index[slot] != 0 &&
+           strcmp(formula->variables[formula->var_index[slot] - 1].name, name) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Function to double the variable index and reinsert every variable
+static bool grow_variable_index(Formula *formula) {
+    int new_capacity = formula->var_index_capacity * GROWTH_FACTOR;
+    int *new_index = calloc(new_capacity, sizeof(int));
+    if (!new_index) return false;
+    free(formula->var_index);
+    formula->var_index = new_index;
+    formula->var_index_capacity = new_capacity;
+    for (int i = 0; i < formula->num_variables; i++) {
+        formula->var_index[variable_slot(formula, formula->variables[i].name)] = i + 1;
+    }
+    return true;
+}
+
+// Function to find a variable in the formula, returns -1 if absent
+int find_variable(Formula *formula, const char *name) {
+    return formula->var_index[variable_slot(formula, name)] - 1;
 }
 
 // Function to find or add a variable to the formula
 int find_or_add_variable(Formula *formula, const char *name) {
     // First try to find the variable
-    for (int i = 0; i < formula->num_variables; i++) {
-        if (strcmp(formula->variables[i].name, name) == 0) {
-            return i;
-        }
+    int slot = variable_slot(formula, name);
+    if (formula->var_index[slot] != 0) {
+        return formula->var_index[slot] - 1;
     }
     
     // If not found, add it
@@ -157,12 +211,22 @@ int find_or_add_variable(Formula *formula, const char *name) {
         formula->variables = new_vars;
         formula->var_capacity = new_capacity;
     }
+    if ((formula->num_variables + 1) * 2 > formula->var_index_capacity) {
+        if (!grow_variable_index(formula)) return -1;
+        slot = variable_slot(formula, name);
+    }
     
     strncpy(formula->variables[formula->num_variables].name, name, MAX_VAR_NAME - 1);
     formula->variables[formula->num_variables].name[MAX_VAR_NAME - 1] = '\0';
+    formula->var_index[slot] = formula->num_variables + 1;
     return formula->num_variables++;
 }
 
+// Function to encode a literal as an integer (2 * variable id, +1 when negated)
+int literal_code(Formula *formula, Literal *literal) {
+    return 2 * find_variable(formula, literal->var.name) + (literal->is_negated ? 1 : 0);
+}
+
 // Function to add a literal to a clause
 bool add_literal(Clause *clause, const char *var_name, bool is_negated) {
     if (clause->num_literals >= clause->capacity) {
@@ -242,20 +306,29 @@ bool formula_contains(Formula *formula, Clause *clause) {
 }
 
 // Function to resolve two clauses on a variable
+// Returns false for tautologies; on allocation failure result->literals is left NULL
 bool resolve(Clause *c1, Clause *c2, const char *var_name, bool is_negated, Clause *result) {
-    init_clause(result);
+    if (!init_clause(result)) return false;
     
-    // Add literals from c1 except var
+    // Add literals from c1 except var, each literal once so resolvents cannot keep growing
     for (int i = 0; i < c1->num_literals; i++) {
-        if (strcmp(c1->literals[i].var.name, var_name) != 0 || c1->literals[i].is_negated != is_negated) {
-            add_literal(result, c1->literals[i].var.name, c1->literals[i].is_negated);
+        if ((strcmp(c1->literals[i].var.name, var_name) != 0 || c1->literals[i].is_negated != is_negated) &&
+            !clause_contains(result, c1->literals[i].var.name, c1->literals[i].is_negated)) {
+            if (!add_literal(result, c1->literals[i].var.name, c1->literals[i].is_negated)) {
+                free_clause(result);
+                return false;
+            }
         }
     }
     
     // Add literals from c2 except -var
     for (int i = 0; i < c2->num_literals; i++) {
-        if (strcmp(c2->literals[i].var.name, var_name) != 0 || c2->literals[i].is_negated != !is_negated) {
-            add_literal(result, c2->literals[i].var.name, c2->literals[i].is_negated);
+        if ((strcmp(c2->literals[i].var.name, var_name) != 0 || c2->literals[i].is_negated != !is_negated) &&
+            !clause_contains(result, c2->literals[i].var.name, c2->literals[i].is_negated)) {
+            if (!add_literal(result, c2->literals[i].var.name, c2->literals[i].is_negated)) {
+                free_clause(result);
+                return false;
+            }
         }
     }
     
@@ -267,6 +340,19 @@ bool resolve(Clause *c1, Clause *c2, const char *var_name, bool is_negated, Clau
     return true;
 }
 
+// Function to release the unused capacity of a clause, returns its final size in bytes
+size_t shrink_clause(Clause *clause) {
+    int new_capacity = clause->num_literals > 0 ? clause->num_literals : 1;
+    if (new_capacity < clause->capacity) {
+        Literal *new_literals = realloc(clause->literals, new_capacity * sizeof(Literal));
+        if (new_literals) {
+            clause->literals = new_literals;
+            clause->capacity = new_capacity;
+        }
+    }
+    return clause->capacity * sizeof(Literal);
+}
+
 // Function to check if a string is a valid variable name
 bool is_valid_variable_name(const char *name) {
     if (!name || !*name) return false;
@@ -354,201 +440,7141 @@ bool unit_propagation(Formula *formula) {
     return true;
 }
 
-// Function to perform resolution by refutation
-bool resolution(Formula *formula) {
-    // Create a working set of clauses
-    Clause *work_clauses = malloc(INITIAL_CAPACITY * sizeof(Clause));
-    int work_capacity = INITIAL_CAPACITY;
-    int work_size = 0;
-    
-    if (!work_clauses) return true;  // Memory error, assume satisfiable
+// Verdict of a solver run
+typedef enum {
+    RESULT_SATISFIABLE,
+    RESULT_UNSATISFIABLE,
+    RESULT_UNKNOWN      // A budget ran out or memory was exhausted before a verdict
+} SolverResult;
+
+// Why a run ended without a verdict
+typedef enum {
+    STOP_NONE,
+    STOP_TIMEOUT,
+    STOP_MEMORY_LIMIT,
+    STOP_CLAUSE_LIMIT,
+    STOP_OUT_OF_MEMORY,
+    STOP_INCOMPLETE,    // The strategy saturated, but its saturation does not prove satisfiability
+    STOP_WIDTH_LIMIT,   // Saturated without the empty clause while discarding wide resolvents
+    STOP_CANCELLED,     // Another component of the formula was refuted first
+    STOP_SPILL_FAILED,  // A run of spilled clauses could not be written or read back
+    STOP_FLIP_LIMIT     // Local search spent its flips without satisfying every clause
+} StopReason;
+
+#define EXIT_UNKNOWN 2
+#define BUDGET_CHECK_INTERVAL 1024  // Pairs tried between two clock/memory checks
+
+// Working set sizes of the threads that share one budget, added up at their budget checks
+typedef struct {
+    volatile LONG64 clauses;
+    volatile LONG64 memory;
+    volatile LONG64 peak_clauses;  // Largest clause total seen at a check
+} BudgetPool;
+
+// Resource limits enforced during saturation (0 means unlimited)
+typedef struct {
+    double timeout;          // Seconds of wall time
+    size_t max_memory;       // Bytes held by the working clause set
+    int max_clauses;         // Clauses in the working set
+    ULONGLONG start_time;    // GetTickCount64() when the run started
+    double progress_interval;  // Seconds between progress reports on stderr (0 = off)
+    ULONGLONG last_progress;
+    volatile LONG *cancel;   // Set by another thread to stop this run, NULL when nothing can cancel it
+    BudgetPool *pool;        // Totals the limits apply to when threads share them, NULL for this run alone
+    long long pooled_clauses;  // This run's part of the pool totals
+    long long pooled_memory;
+    int component;           // Component solved under this budget, named in progress reports (-1 = whole formula)
+} Budget;
+
+// Order in which saturation resolves clause pairs
+typedef enum {
+    STRATEGY_SATURATE,  // Every pair of the working set, round by round
+    STRATEGY_UNIT,      // Given clause picked shortest first (units first), then oldest
+    STRATEGY_SOS,       // Set of support: every pair involves a clause descending from the goal
+    STRATEGY_ORDERED,   // Resolve only on the maximal variable of both clauses (latest in the formula)
+    STRATEGY_ZRES,      // Davis-Putnam elimination on the whole clause set held as a ZBDD
+    STRATEGY_SLS        // No resolution: probSAT local search for a model
+} Strategy;
+
+// Search settings of a solver run
+typedef struct {
+    Strategy strategy;
+    int goal_clauses;   // Set of support: the last n input clauses, 0 for the all-negative clauses
+    int max_width;      // Discard resolvents wider than this, raised from 1 up to the bound (0 = no bound)
+    const char *spill_dir;  // Keep the passive clauses in sorted runs in this directory (NULL = in memory)
+    long long max_flips;    // Local search: flips over all threads before giving up (0 = default)
+    int threads;            // Local search: independent searches, 0 for one per processor
+    unsigned seed;          // Local search: seed of the first thread, the others derive theirs from it
+} SearchOptions;
+
+// Counters and phase timers of a run; the caller zeroes it before solving
+typedef struct {
+    StopReason stop_reason;
+    int variables;
+    int input_clauses;
+    int rounds;              // Completed saturation rounds
+    int given;               // Clauses selected by the given-clause loop (unit and sos strategies)
+    long long pairs_tried;   // Clause pairs examined
+    long long clashes;       // Complementary literals found, i.e. resolution attempts
+    long long tautologies;   // Resolvents rejected because they contain P and !P
+    long long duplicates;    // Resolvents already in the working set
+    long long kept;          // Resolvents added to the working set
+    long long too_wide;      // Resolvents discarded by the width bound
+    int equivalences;        // Variables replaced by an equivalent literal during preprocessing
+    int failed_literals;     // Probed literals whose negation became a unit
+    int hyper_binary;        // Binary resolvents added while probing
+    int blocked;             // Clauses removed as blocked
+    int covered;             // Clauses removed as covered (blocked after covered literal addition)
+    int xors;                // XOR constraints recognised among the clauses
+    int xor_derived;         // Unit and binary clauses read off the reduced XOR rows
+    int at_most_one;         // At-most-one constraints recognised among the binary clauses
+    int exactly_one;         // Of those, constraints whose literals also form a clause
+    int symmetry_generators; // Automorphisms of the formula found by the symmetry search
+    int symmetry_clauses;    // Lex-leader clauses added for them
+    int lemmas_imported;     // Stored lemmas added to the working set
+    int lemmas_exported;     // Resolvents added to the lemma store
+    int clauses;             // Size of the working set
+    int max_clauses;         // Largest size the working set reached
+    int spill_runs;          // Sorted runs of passive clauses written to disk
+    long long spill_bytes;   // Bytes written to those runs
+    long long flips;         // Variables flipped by local search
+    long long restarts;      // Local search restarts from a random assignment
+    size_t memory;           // Bytes held by the working set
+    double parse_time;       // Seconds spent reading the formula
+    double preprocess_time;  // Seconds spent simplifying the formula before saturation
+    double setup_time;       // Seconds spent building the working set
+    double saturation_time;  // Seconds spent in the resolution loop
+} SolverStats;
+
+// Function to read a high resolution clock in seconds
+double now_seconds(void) {
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+}
+
+// Function to order 64-bit keys ascending, for qsort
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Timeline tracing
+ *
+ * Probes record begin/end events with a timestamp into a ring buffer owned by
+ * the calling thread, so threads never contend while recording. The buffers
+ * are written as Chrome trace JSON (chrome://tracing, ui.perfetto.dev) when
+ * --trace is given. Building with -DNO_TRACE compiles every probe away.
+ */
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+#define TRACE_RING_SIZE 65536  // Events kept per thread, older ones are overwritten
+
+typedef struct {
+    const char *name;       // Static string
+    char phase;             // 'B' begin, 'E' end, 'C' counter
+    long long value;        // Argument of begin events (-1 for none), value of counters
+    double timestamp;       // Microseconds since tracing started
+} TraceEvent;
+
+typedef struct TraceBuffer {
+    DWORD thread_id;
+    const char *thread_name;
+    long long count;        // Events recorded, the ring holds the last TRACE_RING_SIZE
+    TraceEvent events[TRACE_RING_SIZE];
+    struct TraceBuffer *next;
+} TraceBuffer;
+
+static bool trace_enabled = false;
+static double trace_origin;
+static CRITICAL_SECTION trace_lock;
+static TraceBuffer *trace_buffers = NULL;
+static THREAD_LOCAL TraceBuffer *trace_local = NULL;
+
+// Function to start recording trace events, call before any worker thread exists
+void trace_start(void) {
+    InitializeCriticalSection(&trace_lock);
+    trace_origin = now_seconds();
+    trace_enabled = true;
+}
+
+// Function to get the ring buffer of the calling thread, registering it on first use
+static TraceBuffer *trace_buffer(void) {
+    if (!trace_local) {
+        TraceBuffer *buffer = malloc(sizeof(TraceBuffer));
+        if (!buffer) return NULL;
+        buffer->thread_id = GetCurrentThreadId();
+        buffer->thread_name = NULL;
+        buffer->count = 0;
+        EnterCriticalSection(&trace_lock);
+        buffer->next = trace_buffers;
+        trace_buffers = buffer;
+        LeaveCriticalSection(&trace_lock);
+        trace_local = buffer;
+    }
+    return trace_local;
+}
+
+// Function to record one trace event for the calling thread
+void trace_event(const char *name, char phase, long long value) {
+    if (!trace_enabled) return;
+    TraceBuffer *buffer = trace_buffer();
+    if (!buffer) return;
+    TraceEvent *event = &buffer->events[buffer->count % TRACE_RING_SIZE];
+    event->name = name;
+    event->phase = phase;
+    event->value = value;
+    event->timestamp = (now_seconds() - trace_origin) * 1e6;
+    buffer->count++;
+}
+
+// Function to label the calling thread in the trace
+void trace_thread_name(const char *name) {
+    if (!trace_enabled) return;
+    TraceBuffer *buffer = trace_buffer();
+    if (buffer) buffer->thread_name = name;
+}
+
+#ifndef NO_TRACE
+#define TRACE_BEGIN(name) trace_event(name, 'B', -1)
+#define TRACE_BEGIN_ARG(name, value) trace_event(name, 'B', (long long)(value))
+#define TRACE_END(name) trace_event(name, 'E', -1)
+#define TRACE_COUNTER(name, value) trace_event(name, 'C', (long long)(value))
+#else
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_BEGIN_ARG(name, value) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)0)
+#endif
+
+// Function to stop tracing and free the ring buffers of every thread
+static void trace_free(void) {
+    trace_enabled = false;
+    trace_local = NULL;
+    while (trace_buffers) {
+        TraceBuffer *next = trace_buffers->next;
+        free(trace_buffers);
+        trace_buffers = next;
+    }
+    DeleteCriticalSection(&trace_lock);
+}
+
+// Function to write all recorded events as Chrome trace JSON and stop tracing
+bool trace_close(const char *filename) {
+    if (!trace_enabled) return true;
+    FILE *out = fopen(filename, "w");
+    if (!out) {
+        trace_free();
+        return false;
+    }
     
-    // Copy original clauses to working set
-    for (int i = 0; i < formula->num_clauses; i++) {
-        if (work_size >= work_capacity) {
-            int new_capacity = work_capacity * GROWTH_FACTOR;
-            Clause *new_work = realloc(work_clauses, new_capacity * sizeof(Clause));
-            if (!new_work) {
-                // Clean up and return
-                for (int j = 0; j < work_size; j++) {
-                    free_clause(&work_clauses[j]);
-                }
-                free(work_clauses);
-                return true;  // Memory error, assume satisfiable
-            }
-            work_clauses = new_work;
-            work_capacity = new_capacity;
+    EnterCriticalSection(&trace_lock);
+    fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    for (TraceBuffer *buffer = trace_buffers; buffer; buffer = buffer->next) {
+        if (buffer->thread_name) {
+            fprintf(out, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %lu, "
+                    "\"args\": {\"name\": \"%s\"}}", first ? "" : ",\n",
+                    (unsigned long)buffer->thread_id, buffer->thread_name);
+            first = false;
         }
         
-        if (!copy_clause(&work_clauses[work_size], &formula->clauses[i])) {
-            // Clean up and return
-            for (int j = 0; j < work_size; j++) {
-                free_clause(&work_clauses[j]);
+        // After the ring wrapped, end events whose begin was overwritten are dropped
+        long long oldest = buffer->count > TRACE_RING_SIZE ? buffer->count - TRACE_RING_SIZE : 0;
+        int depth = 0;
+        for (long long n = oldest; n < buffer->count; n++) {
+            TraceEvent *event = &buffer->events[n % TRACE_RING_SIZE];
+            if (event->phase == 'E' && depth == 0) continue;
+            depth += event->phase == 'B' ? 1 : event->phase == 'E' ? -1 : 0;
+            
+            fprintf(out, "%s{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": %lu",
+                    first ? "" : ",\n", event->name, event->phase, event->timestamp,
+                    (unsigned long)buffer->thread_id);
+            if (event->phase == 'C') {
+                fprintf(out, ", \"args\": {\"%s\": %lld}", event->name, event->value);
+            } else if (event->phase == 'B' && event->value >= 0) {
+                fprintf(out, ", \"args\": {\"n\": %lld}", event->value);
             }
-            free(work_clauses);
-            return true;  // Memory error, assume satisfiable
+            fprintf(out, "}");
+            first = false;
         }
-        work_size++;
     }
+    fprintf(out, "\n]}\n");
+    LeaveCriticalSection(&trace_lock);
     
-    // Perform resolution
-    bool found_empty = false;
-    int start = 0;
-    
-    while (start < work_size && !found_empty) {
-        int end = work_size;
-        
-        for (int i = 0; i < end && !found_empty; i++) {
-            for (int j = i + 1; j < end && !found_empty; j++) {
-                // Try each literal in clause i
-                for (int k = 0; k < work_clauses[i].num_literals; k++) {
-                    const char *var = work_clauses[i].literals[k].var.name;
-                    bool is_negated = work_clauses[i].literals[k].is_negated;
-                    
-                    // Look for complementary literal
-                    if (clause_contains(&work_clauses[j], var, !is_negated)) {
-                        Clause resolvant;
-                        if (!init_clause(&resolvant)) continue;
-                        
-                        if (resolve(&work_clauses[i], &work_clauses[j], var, is_negated, &resolvant)) {
-                            if (is_empty_clause(&resolvant)) {
-                                found_empty = true;
-                                free_clause(&resolvant);
-                                break;
-                            }
-                            
-                            // Check if this is a new clause
-                            bool is_new = true;
-                            for (int m = 0; m < work_size; m++) {
-                                if (clauses_equal(&work_clauses[m], &resolvant)) {
-                                    is_new = false;
-                                    break;
-                                }
-                            }
-                            
-                            if (is_new) {
-                                if (work_size >= work_capacity) {
-                                    int new_capacity = work_capacity * GROWTH_FACTOR;
-                                    Clause *new_work = realloc(work_clauses, new_capacity * sizeof(Clause));
-                                    if (!new_work) {
-                                        free_clause(&resolvant);
-                                        continue;
-                                    }
-                                    work_clauses = new_work;
-                                    work_capacity = new_capacity;
-                                }
-                                work_clauses[work_size++] = resolvant;
-                            } else {
-                                free_clause(&resolvant);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        start = end;
+    trace_free();
+    return fclose(out) == 0;
+}
+
+// Function to describe a verdict
+const char *result_text(SolverResult result) {
+    switch (result) {
+        case RESULT_SATISFIABLE:   return "SATISFIABLE";
+        case RESULT_UNSATISFIABLE: return "UNSATISFIABLE";
+        default:                   return "UNKNOWN";
+    }
+}
+
+// Function to name a stop reason in machine-readable output
+const char *stop_reason_name(StopReason reason) {
+    switch (reason) {
+        case STOP_TIMEOUT:       return "timeout";
+        case STOP_MEMORY_LIMIT:  return "memory_limit";
+        case STOP_CLAUSE_LIMIT:  return "clause_limit";
+        case STOP_OUT_OF_MEMORY: return "out_of_memory";
+        case STOP_INCOMPLETE:    return "incomplete";
+        case STOP_WIDTH_LIMIT:   return "width_limit";
+        case STOP_CANCELLED:     return "cancelled";
+        case STOP_SPILL_FAILED:  return "spill_failed";
+        case STOP_FLIP_LIMIT:    return "flip_limit";
+        default:                 return "none";
     }
+}
+
+// Function to write the statistics as a single JSON object
+// A component index of 0 or more adds a "component" field, so the reports of parallel components can be told apart
+void print_stats_json(FILE *out, SolverStats *stats, const char *result, int component) {
+    char component_field[32] = "";
+    if (component >= 0) snprintf(component_field, sizeof(component_field), "\"component\": %d, ", component);
+    fprintf(out, "{\"result\": \"%s\", %s\"stop_reason\": \"%s\", "
+            "\"variables\": %d, \"input_clauses\": %d, \"rounds\": %d, \"given\": %d, "
+            "\"pairs_tried\": %lld, \"clashes\": %lld, \"tautologies\": %lld, "
+            "\"duplicates\": %lld, \"kept\": %lld, \"too_wide\": %lld, \"clauses\": %d, \"max_clauses\": %d, "
+            "\"equivalences\": %d, \"failed_literals\": %d, \"hyper_binary\": %d, \"blocked\": %d, \"covered\": %d, "
+            "\"xors\": %d, \"xor_derived\": %d, \"at_most_one\": %d, \"exactly_one\": %d, "
+            "\"symmetry_generators\": %d, \"symmetry_clauses\": %d, \"lemmas_imported\": %d, \"lemmas_exported\": %d, "
+            "\"spill_runs\": %d, \"spill_bytes\": %lld, \"flips\": %lld, \"restarts\": %lld, "
+            "\"memory_bytes\": %llu, \"time\": {\"parse\": %.6f, \"preprocess\": %.6f, \"setup\": %.6f, "
+            "\"saturation\": %.6f}}\n",
+            result, component_field, stop_reason_name(stats->stop_reason),
+            stats->variables, stats->input_clauses, stats->rounds, stats->given,
+            stats->pairs_tried, stats->clashes, stats->tautologies,
+            stats->duplicates, stats->kept, stats->too_wide, stats->clauses, stats->max_clauses,
+            stats->equivalences, stats->failed_literals, stats->hyper_binary, stats->blocked, stats->covered,
+            stats->xors, stats->xor_derived, stats->at_most_one, stats->exactly_one,
+            stats->symmetry_generators, stats->symmetry_clauses, stats->lemmas_imported, stats->lemmas_exported,
+            stats->spill_runs, stats->spill_bytes, stats->flips, stats->restarts,
+            (unsigned long long)stats->memory, stats->parse_time, stats->preprocess_time, stats->setup_time,
+            stats->saturation_time);
+    fflush(out);
+}
+
+// Function to add the change in this run's working set to the pool, returns the new totals
+static void budget_pool_update(Budget *budget, long long clauses, long long memory,
+                               long long *total_clauses, long long *total_memory) {
+    BudgetPool *pool = budget->pool;
+    *total_clauses = InterlockedExchangeAdd64(&pool->clauses, clauses - budget->pooled_clauses) +
+                     clauses - budget->pooled_clauses;
+    *total_memory = InterlockedExchangeAdd64(&pool->memory, memory - budget->pooled_memory) +
+                    memory - budget->pooled_memory;
+    budget->pooled_clauses = clauses;
+    budget->pooled_memory = memory;
     
-    // Clean up
-    for (int i = 0; i < work_size; i++) {
-        free_clause(&work_clauses[i]);
+    LONG64 peak = pool->peak_clauses;
+    while (*total_clauses > peak) {
+        LONG64 seen = InterlockedCompareExchange64(&pool->peak_clauses, *total_clauses, peak);
+        if (seen == peak) break;
+        peak = seen;
     }
-    free(work_clauses);
+}
+
+// Function to check the budget, records the reason in stats when exhausted
+bool budget_exhausted(Budget *budget, SolverStats *stats) {
+    long long clauses = stats->clauses, memory = (long long)stats->memory;
+    if (budget->pool) budget_pool_update(budget, clauses, memory, &clauses, &memory);
     
-    return !found_empty;
+    if (budget->cancel && *budget->cancel) {
+        stats->stop_reason = STOP_CANCELLED;
+    } else if (budget->max_clauses > 0 && clauses > budget->max_clauses) {
+        stats->stop_reason = STOP_CLAUSE_LIMIT;
+    } else if (budget->max_memory > 0 && memory > (long long)budget->max_memory) {
+        stats->stop_reason = STOP_MEMORY_LIMIT;
+    } else if (budget->timeout > 0 || budget->progress_interval > 0) {
+        ULONGLONG now = GetTickCount64();
+        if (budget->timeout > 0 && (double)(now - budget->start_time) >= budget->timeout * 1000.0) {
+            stats->stop_reason = STOP_TIMEOUT;
+        } else if (budget->progress_interval > 0 &&
+                   (double)(now - budget->last_progress) >= budget->progress_interval * 1000.0) {
+            budget->last_progress = now;
+            print_stats_json(stderr, stats, "RUNNING", budget->component);
+        }
+    }
+    return stats->stop_reason != STOP_NONE;
 }
 
-// Function to read a formula from a file
-bool read_formula_from_file(const char *filename, Formula *formula) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        printf("Error: Unable to open file %s\n", filename);
-        return false;
+// Function to describe why a run stopped
+const char *stop_reason_text(StopReason reason) {
+    switch (reason) {
+        case STOP_TIMEOUT:       return "time limit reached";
+        case STOP_MEMORY_LIMIT:  return "memory limit reached";
+        case STOP_CLAUSE_LIMIT:  return "clause limit reached";
+        case STOP_OUT_OF_MEMORY: return "out of memory";
+        case STOP_INCOMPLETE:    return "set of support saturated without a refutation";
+        case STOP_WIDTH_LIMIT:   return "no refutation within the width bound";
+        case STOP_CANCELLED:     return "cancelled";
+        case STOP_SPILL_FAILED:  return "spill file could not be written or read";
+        case STOP_FLIP_LIMIT:    return "flip limit reached";
+        default:                 return "not stopped";
     }
-    
-    if (!init_formula(formula)) {
-        printf("Error: Failed to initialize formula\n");
-        fclose(file);
-        return false;
+}
+
+/*
+ * Checkpoints
+ *
+ * With --checkpoint the working set and the position of the saturation loop
+ * are saved periodically, so a long run that gets stopped can be continued with
+ * --resume instead of starting over. At its budget check the loop hands the
+ * writer thread a copy of the clause headers, its cursor and its counters, then
+ * carries on: the literal arrays of a clause never change once it is in the
+ * working set, so the writer can read them while new clauses are added. Each
+ * snapshot goes to <file>.tmp and replaces the previous one once complete.
+ *
+ * The file is a fixed-layout image that can be used in place once mapped: a
+ * header, one record per working set clause, the literal codes of all clauses
+ * (2 * variable + negated over the formula being saturated), then the waiting
+ * heap and active list of the given-clause loop, each array 8-byte aligned.
+ * The header keeps a hash of the formula and the search settings, since a
+ * snapshot only makes sense for the run it was taken from, and a hash of the
+ * arrays that follow it, so a damaged or edited file is refused.
+ */
+
+#define SNAPSHOT_MAGIC "LSSNAP2"      // 8 bytes with the terminator, the digit is the format version
+#define CHECKPOINT_INTERVAL 300       // Default seconds between two snapshots
+#define CHECKPOINT_IO_CODES (1 << 16) // Literal codes staged per write
+
+// Position of a saturation loop before its next pair, from which it continues exactly
+typedef struct {
+    int width;                // Width bound of the pass (0 = none)
+    long long pass_too_wide;  // too_wide when the pass started
+    int end, i, j;            // Round saturation: clauses held at the start of the round, next pair
+    int given, next_active;   // Given-clause loop: clause being resolved (-1 = none), its next partner in active
+    int *waiting;             // Given-clause loop: heap of waiting clauses
+    int waiting_size;
+    int *active;              // Given-clause loop: clauses selected so far
+    int active_size;
+} SaturationCursor;
+
+// Header of a snapshot file, the arrays follow at the given byte offsets
+typedef struct {
+    char magic[8];
+    uint64_t formula_hash;
+    uint64_t content_hash;     // Hash of the clause records, literal codes, waiting heap and active list
+    uint64_t clauses_offset;   // SnapshotClause per working set clause
+    uint64_t literals_offset;  // int32 literal codes of all clauses in order
+    uint64_t waiting_offset;   // int32 waiting heap
+    uint64_t active_offset;    // int32 active list
+    int64_t pass_too_wide;
+    int64_t pairs_tried, clashes, tautologies, duplicates, kept, too_wide;
+    double saturation_time;
+    int32_t strategy, goal_clauses, max_width;
+    int32_t num_clauses;
+    int32_t width, end, i, j, given, next_active, waiting_size, active_size;
+    int32_t rounds, given_count, max_clauses, reserved;
+} SnapshotHeader;
+
+typedef struct {
+    uint64_t first;            // Index of its first literal code
+    int32_t num_literals;
+    int32_t parents[2];
+    int32_t reserved;
+} SnapshotClause;
+
+typedef struct {
+    char path[MAX_PATH];
+    double interval;           // Seconds between two snapshots
+    ULONGLONG last;            // GetTickCount64() when the last snapshot was taken
+    Formula *formula;          // Formula being saturated, gives the literal codes
+    SearchOptions *search;
+    uint64_t formula_hash;
+    Clause *clauses;           // Snapshot handed to the writer: clause headers, the literals stay shared
+    int num_clauses;
+    int clauses_capacity;
+    SaturationCursor cursor;   // Its waiting and active arrays are copies owned here
+    int waiting_capacity;
+    int active_capacity;
+    SolverStats stats;
+    int32_t *codes;            // Staging buffer of the writer
+    bool pending;              // A snapshot is waiting for or being written
+    bool closing;
+    bool failed;               // A snapshot could not be written
+    int written;
+    HANDLE thread;
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE changed;
+} Checkpointer;
+
+// Snapshot read back for --resume
+typedef struct {
+    unsigned char *image;      // The whole file
+    size_t size;
+    SnapshotHeader *header;
+} Snapshot;
+
+static Checkpointer *checkpoint_log = NULL;  // Checkpoints taken by the solver, NULL when off
+static Snapshot *resume_snapshot = NULL;     // Snapshot the next saturation continues from, NULL to start afresh
+
+// Function to hash the variables and clauses of a formula in order
+static uint64_t snapshot_hash(Formula *formula) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (uint64_t)formula->num_variables;
+    for (int v = 0; v < formula->num_variables; v++) {
+        for (const char *c = formula->variables[v].name; *c; c++) h = (h ^ (unsigned char)*c) * 0x100000001B3ULL;
+        h = (h ^ 0xFF) * 0x100000001B3ULL;
+    }
+    for (int c = 0; c < formula->num_clauses; c++) {
+        Clause *clause = &formula->clauses[c];
+        h = (h ^ (uint64_t)clause->num_literals ^ 0x100) * 0x100000001B3ULL;
+        for (int k = 0; k < clause->num_literals; k++) {
+            h = (h ^ (uint64_t)(unsigned)literal_code(formula, &clause->literals[k])) * 0x100000001B3ULL;
+        }
+    }
+    return h ^ (h >> 29);
+}
+
+// Function to add 32-bit words of a snapshot array to its content hash
+static uint64_t snapshot_hash_words(uint64_t h, const void *data, size_t count) {
+    const uint32_t *words = data;
+    for (size_t w = 0; w < count; w++) {
+        h = (h ^ words[w]) * 0x100000001B3ULL;
+        h ^= h >> 32;
     }
+    return h;
+}
+
+// Function to pad a snapshot file with zeros up to the next multiple of 8 bytes
+static bool snapshot_align(FILE *file, uint64_t *offset) {
+    static const char zeros[8] = {0};
+    size_t padding = (size_t)((8 - *offset % 8) % 8);
+    *offset += padding;
+    return fwrite(zeros, 1, padding, file) == padding;
+}
+
+// Function to write the snapshot held by the checkpointer to a temporary file and move it into place
+static bool checkpoint_write(Checkpointer *cp) {
+    char temporary[MAX_PATH + 8];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", cp->path);
+    FILE *file = fopen(temporary, "wb");
+    if (!file) return false;
     
-    char line[MAX_LINE_LENGTH];
-    int line_num = 0;
+    uint64_t num_codes = 0;
+    for (int c = 0; c < cp->num_clauses; c++) num_codes += (uint64_t)cp->clauses[c].num_literals;
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.formula_hash = cp->formula_hash;
+    header.clauses_offset = sizeof(SnapshotHeader);
+    header.literals_offset = header.clauses_offset + (uint64_t)cp->num_clauses * sizeof(SnapshotClause);
+    header.waiting_offset = (header.literals_offset + num_codes * sizeof(int32_t) + 7) / 8 * 8;
+    header.active_offset = (header.waiting_offset + (uint64_t)cp->cursor.waiting_size * sizeof(int32_t) + 7) / 8 * 8;
+    header.pass_too_wide = cp->cursor.pass_too_wide;
+    header.pairs_tried = cp->stats.pairs_tried;
+    header.clashes = cp->stats.clashes;
+    header.tautologies = cp->stats.tautologies;
+    header.duplicates = cp->stats.duplicates;
+    header.kept = cp->stats.kept;
+    header.too_wide = cp->stats.too_wide;
+    header.saturation_time = cp->stats.saturation_time;
+    header.strategy = (int32_t)cp->search->strategy;
+    header.goal_clauses = cp->search->goal_clauses;
+    header.max_width = cp->search->max_width;
+    header.num_clauses = cp->num_clauses;
+    header.width = cp->cursor.width;
+    header.end = cp->cursor.end;
+    header.i = cp->cursor.i;
+    header.j = cp->cursor.j;
+    header.given = cp->cursor.given;
+    header.next_active = cp->cursor.next_active;
+    header.waiting_size = cp->cursor.waiting_size;
+    header.active_size = cp->cursor.active_size;
+    header.rounds = cp->stats.rounds;
+    header.given_count = cp->stats.given;
+    header.max_clauses = cp->stats.max_clauses;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
     
-    while (fgets(line, sizeof(line), file)) {
-        line_num++;
-        
-        // Remove trailing newline and whitespace
-        char *end = line + strlen(line) - 1;
-        while (end >= line && isspace(*end)) *end-- = '\0';
-        
-        // Skip empty lines and comments
-        if (line[0] == '\0' || line[0] == '#') continue;
-        
-        Clause clause;
-        if (!init_clause(&clause)) {
-            free_formula(formula);
-            fclose(file);
-            return false;
-        }
-        
-        char *token = strtok(line, " \t");
-        while (token) {
-            bool is_negated = (token[0] == '!');
-            char *var_name = token + (is_negated ? 1 : 0);
-            
-            if (!is_valid_variable_name(var_name)) {
-                free_clause(&clause);
-                free_formula(formula);
-                fclose(file);
-                return false;
-            }
-            
-            if (!add_literal(&clause, var_name, is_negated)) {
-                free_clause(&clause);
-                free_formula(formula);
-                fclose(file);
-                return false;
+    // The content hash covers the arrays as written; the header is rewritten with it at the end
+    uint64_t h = 0x9E3779B97F4A7C15ULL;
+    uint64_t first = 0;
+    for (int c = 0; c < cp->num_clauses && ok; c++) {
+        SnapshotClause record = {first, cp->clauses[c].num_literals,
+                                 {cp->clauses[c].parents[0], cp->clauses[c].parents[1]}, 0};
+        h = snapshot_hash_words(h, &record, sizeof(record) / sizeof(uint32_t));
+        ok = fwrite(&record, sizeof(record), 1, file) == 1;
+        first += (uint64_t)cp->clauses[c].num_literals;
+    }
+    int staged = 0;
+    for (int c = 0; c < cp->num_clauses && ok; c++) {
+        for (int k = 0; k < cp->clauses[c].num_literals && ok; k++) {
+            cp->codes[staged++] = literal_code(cp->formula, &cp->clauses[c].literals[k]);
+            if (staged == CHECKPOINT_IO_CODES) {
+                h = snapshot_hash_words(h, cp->codes, staged);
+                ok = fwrite(cp->codes, sizeof(int32_t), staged, file) == (size_t)staged;
+                staged = 0;
             }
-            
-            token = strtok(NULL, " \t");
         }
+    }
+    if (ok && staged > 0) {
+        h = snapshot_hash_words(h, cp->codes, staged);
+        ok = fwrite(cp->codes, sizeof(int32_t), staged, file) == (size_t)staged;
+    }
+    uint64_t offset = header.literals_offset + num_codes * sizeof(int32_t);
+    ok = ok && snapshot_align(file, &offset);
+    for (int w = 0; w < cp->cursor.waiting_size && ok; w++) {
+        int32_t index = cp->cursor.waiting[w];
+        ok = fwrite(&index, sizeof(index), 1, file) == 1;
+    }
+    h = snapshot_hash_words(h, cp->cursor.waiting, cp->cursor.waiting_size);
+    offset += (uint64_t)cp->cursor.waiting_size * sizeof(int32_t);
+    ok = ok && snapshot_align(file, &offset);
+    for (int a = 0; a < cp->cursor.active_size && ok; a++) {
+        int32_t index = cp->cursor.active[a];
+        ok = fwrite(&index, sizeof(index), 1, file) == 1;
+    }
+    h = snapshot_hash_words(h, cp->cursor.active, cp->cursor.active_size);
+    header.content_hash = h;
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    if (fclose(file) != 0) ok = false;
+    
+    if (ok) ok = MoveFileExA(temporary, cp->path, MOVEFILE_REPLACE_EXISTING) != 0;
+    if (!ok) remove(temporary);
+    return ok;
+}
+
+// Function run by the checkpoint thread: writes each snapshot handed over by the solver
+static DWORD WINAPI checkpoint_thread(void *param) {
+    Checkpointer *cp = param;
+    trace_thread_name("checkpoint writer");
+    EnterCriticalSection(&cp->lock);
+    for (;;) {
+        while (!cp->pending && !cp->closing) {
+            SleepConditionVariableCS(&cp->changed, &cp->lock, INFINITE);
+        }
+        if (!cp->pending) break;
         
-        if (clause.num_literals > 0 && !is_tautology(&clause)) {
-            if (!add_clause(formula, &clause)) {
-                free_clause(&clause);
-                free_formula(formula);
-                fclose(file);
-                return false;
-            }
+        LeaveCriticalSection(&cp->lock);
+        TRACE_BEGIN("io:checkpoint");
+        bool written = checkpoint_write(cp);
+        TRACE_END("io:checkpoint");
+        EnterCriticalSection(&cp->lock);
+        if (written) {
+            cp->written++;
+        } else {
+            cp->failed = true;
         }
-        free_clause(&clause);
+        cp->pending = false;
+        WakeAllConditionVariable(&cp->changed);
+    }
+    LeaveCriticalSection(&cp->lock);
+    return 0;
+}
+
+// Function to prepare periodic snapshots of the saturation of a formula and start the writer thread
+bool checkpoint_open(Checkpointer *cp, const char *filename, double interval, Formula *formula,
+                     SearchOptions *search) {
+    memset(cp, 0, sizeof(*cp));
+    if (strlen(filename) >= MAX_PATH) {
+        printf("Error: Checkpoint file name %s is too long\n", filename);
+        return false;
     }
+    strcpy(cp->path, filename);
     
+    // Fail now rather than after hours of saturation if the snapshot cannot be created
+    char temporary[MAX_PATH + 8];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", filename);
+    FILE *file = fopen(temporary, "wb");
+    if (!file) {
+        printf("Error: Unable to create checkpoint file %s\n", temporary);
+        return false;
+    }
     fclose(file);
+    remove(temporary);
+    cp->interval = interval > 0 ? interval : CHECKPOINT_INTERVAL;
+    cp->last = GetTickCount64();
+    cp->formula = formula;
+    cp->search = search;
+    cp->formula_hash = snapshot_hash(formula);
+    cp->codes = malloc(CHECKPOINT_IO_CODES * sizeof(int32_t));
+    if (!cp->codes) {
+        printf("Error: Not enough memory for the checkpoint buffer\n");
+        return false;
+    }
+    InitializeCriticalSection(&cp->lock);
+    InitializeConditionVariable(&cp->changed);
+    cp->thread = CreateThread(NULL, 0, checkpoint_thread, cp, 0, NULL);
+    if (!cp->thread) {
+        printf("Error: Unable to start the checkpoint writer thread\n");
+        DeleteCriticalSection(&cp->lock);
+        free(cp->codes);
+        return false;
+    }
     return true;
 }
 
-// Main function with improved formatting
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        printf("Usage: %s <filename>\n", argv[0]);
-        return 1;
+// Function to copy an index array into a snapshot array owned by the checkpointer
+static bool checkpoint_copy(int **array, int *capacity, const int *source, int size) {
+    if (size > *capacity) {
+        int new_capacity = size > INITIAL_CAPACITY ? size * GROWTH_FACTOR : INITIAL_CAPACITY;
+        int *new_array = realloc(*array, (size_t)new_capacity * sizeof(int));
+        if (!new_array) return false;
+        *array = new_array;
+        *capacity = new_capacity;
+    }
+    if (size > 0) memcpy(*array, source, (size_t)size * sizeof(int));
+    return true;
+}
+
+// Function to hand a snapshot of the saturation to the writer thread once the interval has passed
+// A snapshot is skipped while the previous one is still being written, unless it is the final one
+// taken when the budget stops the run, which waits for it
+void checkpoint_save(Checkpointer *cp, Clause *work_clauses, int work_size, SaturationCursor *cursor,
+                     SolverStats *stats, bool final) {
+    if (!final && (double)(GetTickCount64() - cp->last) < cp->interval * 1000.0) return;
+    EnterCriticalSection(&cp->lock);
+    if (cp->pending && !final) {
+        LeaveCriticalSection(&cp->lock);
+        return;
+    }
+    while (cp->pending) {
+        SleepConditionVariableCS(&cp->changed, &cp->lock, INFINITE);
     }
     
-    Formula formula;
-    if (!read_formula_from_file(argv[1], &formula)) {
-        return 1;
+    // The writer is idle, so the snapshot arrays can be refilled without it noticing
+    bool copied = true;
+    if (work_size > cp->clauses_capacity) {
+        int new_capacity = work_size * GROWTH_FACTOR;
+        Clause *new_clauses = realloc(cp->clauses, (size_t)new_capacity * sizeof(Clause));
+        if (new_clauses) {
+            cp->clauses = new_clauses;
+            cp->clauses_capacity = new_capacity;
+        } else {
+            copied = false;
+        }
+    }
+    int *waiting = cp->cursor.waiting, *active = cp->cursor.active;
+    copied = copied && checkpoint_copy(&waiting, &cp->waiting_capacity, cursor->waiting, cursor->waiting_size);
+    cp->cursor.waiting = waiting;
+    copied = copied && checkpoint_copy(&active, &cp->active_capacity, cursor->active, cursor->active_size);
+    cp->cursor.active = active;
+    if (copied) {
+        memcpy(cp->clauses, work_clauses, (size_t)work_size * sizeof(Clause));
+        cp->num_clauses = work_size;
+        cp->cursor = *cursor;
+        cp->cursor.waiting = waiting;
+        cp->cursor.active = active;
+        cp->stats = *stats;
+        cp->pending = true;
+        WakeAllConditionVariable(&cp->changed);
+    } else {
+        cp->failed = true;
+    }
+    cp->last = GetTickCount64();
+    LeaveCriticalSection(&cp->lock);
+}
+
+// Function to wait until the writer thread is done with the last snapshot, whose literals it still reads
+void checkpoint_wait(Checkpointer *cp) {
+    EnterCriticalSection(&cp->lock);
+    while (cp->pending) {
+        SleepConditionVariableCS(&cp->changed, &cp->lock, INFINITE);
+    }
+    LeaveCriticalSection(&cp->lock);
+}
+
+// Function to stop the writer thread, returns false if any snapshot could not be written
+bool checkpoint_close(Checkpointer *cp) {
+    EnterCriticalSection(&cp->lock);
+    while (cp->pending) {
+        SleepConditionVariableCS(&cp->changed, &cp->lock, INFINITE);
     }
+    cp->closing = true;
+    WakeAllConditionVariable(&cp->changed);
+    LeaveCriticalSection(&cp->lock);
+    WaitForSingleObject(cp->thread, INFINITE);
+    CloseHandle(cp->thread);
+    DeleteCriticalSection(&cp->lock);
     
-    bool is_satisfiable = resolution(&formula);
+    free(cp->clauses);
+    free(cp->cursor.waiting);
+    free(cp->cursor.active);
+    free(cp->codes);
+    return !cp->failed;
+}
+
+// Function to check that an array of a snapshot lies within the file
+static bool snapshot_holds(Snapshot *snapshot, uint64_t offset, uint64_t count, size_t item) {
+    return offset % 8 == 0 && offset <= snapshot->size && count <= (snapshot->size - offset) / item;
+}
+
+// Function to read a snapshot and check it belongs to the saturation of this formula with these settings
+bool snapshot_load(Snapshot *snapshot, const char *filename, Formula *formula, SearchOptions *search) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        printf("Error: Unable to open snapshot file %s\n", filename);
+        return false;
+    }
+    size_t capacity = 1 << 20;
+    snapshot->image = malloc(capacity);
+    bool ok = snapshot->image != NULL;
+    while (ok) {
+        if (snapshot->size == capacity) {
+            unsigned char *new_image = realloc(snapshot->image, capacity * GROWTH_FACTOR);
+            if (!new_image) {
+                ok = false;
+                break;
+            }
+            snapshot->image = new_image;
+            capacity *= GROWTH_FACTOR;
+        }
+        size_t read = fread(snapshot->image + snapshot->size, 1, capacity - snapshot->size, file);
+        snapshot->size += read;
+        if (read == 0) break;
+    }
+    if (ferror(file)) ok = false;
+    fclose(file);
+    if (!ok) {
+        printf("Error: Unable to read snapshot file %s\n", filename);
+        free(snapshot->image);
+        return false;
+    }
     
-    if (is_satisfiable) {
-        printf("SATISFIABLE\n");
-    } else {
-        printf("UNSATISFIABLE\n");
+    // The offsets and sizes of the header must fit the file before anything is read through them
+    SnapshotHeader *h = (SnapshotHeader *)snapshot->image;
+    snapshot->header = h;
+    bool valid = snapshot->size >= sizeof(SnapshotHeader) && memcmp(h->magic, SNAPSHOT_MAGIC, 8) == 0 &&
+                 h->num_clauses >= 0 && h->waiting_size >= 0 && h->active_size >= 0 &&
+                 snapshot_holds(snapshot, h->clauses_offset, (uint64_t)h->num_clauses, sizeof(SnapshotClause)) &&
+                 h->literals_offset <= h->waiting_offset &&
+                 snapshot_holds(snapshot, h->waiting_offset, (uint64_t)h->waiting_size, sizeof(int32_t)) &&
+                 snapshot_holds(snapshot, h->active_offset, (uint64_t)h->active_size, sizeof(int32_t)) &&
+                 h->given >= -1 && h->given < h->num_clauses && h->next_active >= 0 &&
+                 h->next_active <= h->active_size && h->end >= 0 && h->end <= h->num_clauses &&
+                 h->i >= 0 && h->j >= 0 && h->width >= 0;
+    if (valid && (h->formula_hash != snapshot_hash(formula) || h->strategy != (int32_t)search->strategy ||
+                  h->goal_clauses != search->goal_clauses || h->max_width != search->max_width)) {
+        printf("Error: Snapshot %s was taken from another formula or with other search settings\n", filename);
+        free(snapshot->image);
+        return false;
     }
+    // The clause records must lay out the literal pool back to back, as the writer does
+    SnapshotClause *records = valid ? (SnapshotClause *)(snapshot->image + h->clauses_offset) : NULL;
+    int32_t *codes = valid ? (int32_t *)(snapshot->image + h->literals_offset) : NULL;
+    uint64_t num_codes = valid ? (h->waiting_offset - h->literals_offset) / sizeof(int32_t) : 0, used = 0;
+    for (int c = 0; valid && c < h->num_clauses; c++) {
+        valid = records[c].num_literals >= 0 && records[c].first == used &&
+                (uint64_t)records[c].num_literals <= num_codes - used;
+        used += valid ? (uint64_t)records[c].num_literals : 0;
+    }
+    int32_t *waiting = valid ? (int32_t *)(snapshot->image + h->waiting_offset) : NULL;
+    int32_t *active = valid ? (int32_t *)(snapshot->image + h->active_offset) : NULL;
     
-    free_formula(&formula);
-    return 0;
+    // Clause lengths and literal codes are only trusted when they hash to what the writer saw
+    if (valid) {
+        uint64_t content = 0x9E3779B97F4A7C15ULL;
+        content = snapshot_hash_words(content, records,
+                                      (size_t)h->num_clauses * sizeof(SnapshotClause) / sizeof(uint32_t));
+        content = snapshot_hash_words(content, codes, (size_t)used);
+        content = snapshot_hash_words(content, waiting, (size_t)h->waiting_size);
+        content = snapshot_hash_words(content, active, (size_t)h->active_size);
+        if (content != h->content_hash) {
+            printf("Error: Snapshot %s is damaged, its clauses do not match the hash it was written with\n", filename);
+            free(snapshot->image);
+            return false;
+        }
+    }
+    
+    // Every index must still name a variable or an earlier clause, so resuming cannot read out of bounds
+    for (int c = 0; valid && c < h->num_clauses; c++) {
+        valid = records[c].parents[0] >= 0 && records[c].parents[0] <= c &&
+                records[c].parents[1] >= 0 && records[c].parents[1] <= c;
+        for (int k = 0; k < records[c].num_literals && valid; k++) {
+            int32_t code = codes[records[c].first + k];
+            valid = code >= 0 && code < 2 * formula->num_variables;
+        }
+    }
+    for (int w = 0; valid && w < h->waiting_size; w++) valid = waiting[w] >= 0 && waiting[w] < h->num_clauses;
+    for (int a = 0; valid && a < h->active_size; a++) valid = active[a] >= 0 && active[a] < h->num_clauses;
+    if (!valid || h->num_clauses < formula->num_clauses) {
+        printf("Error: %s is not a valid snapshot file\n", filename);
+        free(snapshot->image);
+        return false;
+    }
+    return true;
+}
+
+// Function to rebuild working set clause c of a snapshot
+bool snapshot_clause(Snapshot *snapshot, Formula *formula, int c, Clause *clause) {
+    SnapshotClause *record = (SnapshotClause *)(snapshot->image + snapshot->header->clauses_offset) + c;
+    int32_t *codes = (int32_t *)(snapshot->image + snapshot->header->literals_offset) + record->first;
+    if (!init_clause(clause)) return false;
+    for (int k = 0; k < record->num_literals; k++) {
+        if (!add_literal(clause, formula->variables[codes[k] / 2].name, codes[k] % 2 == 1)) {
+            free_clause(clause);
+            return false;
+        }
+    }
+    clause->parents[0] = record->parents[0];
+    clause->parents[1] = record->parents[1];
+    return true;
+}
+
+// Function to restore the counters and the loop position of a snapshot; the cursor arrays point into it
+void snapshot_restore(Snapshot *snapshot, SaturationCursor *cursor, SolverStats *stats) {
+    SnapshotHeader *h = snapshot->header;
+    cursor->width = h->width;
+    cursor->pass_too_wide = h->pass_too_wide;
+    cursor->end = h->end;
+    cursor->i = h->i;
+    cursor->j = h->j;
+    cursor->given = h->given;
+    cursor->next_active = h->next_active;
+    cursor->waiting = (int *)(snapshot->image + h->waiting_offset);
+    cursor->waiting_size = h->waiting_size;
+    cursor->active = (int *)(snapshot->image + h->active_offset);
+    cursor->active_size = h->active_size;
+    stats->rounds = h->rounds;
+    stats->given = h->given_count;
+    stats->pairs_tried = h->pairs_tried;
+    stats->clashes = h->clashes;
+    stats->tautologies = h->tautologies;
+    stats->duplicates = h->duplicates;
+    stats->kept = h->kept;
+    stats->too_wide = h->too_wide;
+    stats->saturation_time = h->saturation_time;
+    if (h->max_clauses > stats->max_clauses) stats->max_clauses = h->max_clauses;
+}
+
+// Function to free a snapshot read back
+void snapshot_free(Snapshot *snapshot) {
+    free(snapshot->image);
+    snapshot->image = NULL;
+    snapshot->header = NULL;
+}
+
+/*
+ * Proof logging
+ *
+ * With --proof every kept resolvent is streamed to a file in binary LRAT
+ * (clause id, literals, then the ids of the two parents as hints) or binary
+ * DRAT (literals only). Variable v is the v-th distinct variable of the
+ * formula and input clause c its c-th non-tautological line, so a resolvent
+ * stored at index i of the working set has id i + 1. The pivot is implied:
+ * it is the one literal of the first parent missing from the resolvent.
+ *
+ * The solver fills one buffer while a writer thread flushes the other, so
+ * logging never waits on the disk unless the disk falls a full buffer behind.
+ */
+
+#define PROOF_BUFFER_SIZE (1 << 20)
+
+typedef enum {
+    PROOF_LRAT,
+    PROOF_DRAT
+} ProofFormat;
+
+typedef struct {
+    FILE *file;
+    ProofFormat format;
+    Formula *formula;        // Gives each variable name its number
+    unsigned char *buffers[2];
+    size_t length;           // Bytes in the buffer being filled
+    int active;              // Buffer being filled by the solver
+    size_t pending;          // Bytes of the other buffer still to be written, 0 when idle
+    bool closing;
+    bool failed;             // A write failed, the proof is incomplete
+    long long steps;
+    long long bytes;
+    HANDLE thread;
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE changed;
+} ProofWriter;
+
+static ProofWriter *proof_log = NULL;  // Proof written by the solver, NULL when logging is off
+
+// Function run by the writer thread: writes each buffer handed over by the solver
+static DWORD WINAPI proof_writer_thread(void *param) {
+    ProofWriter *proof = param;
+    trace_thread_name("proof writer");
+    EnterCriticalSection(&proof->lock);
+    for (;;) {
+        while (proof->pending == 0 && !proof->closing) {
+            SleepConditionVariableCS(&proof->changed, &proof->lock, INFINITE);
+        }
+        if (proof->pending == 0) break;
+        
+        unsigned char *buffer = proof->buffers[1 - proof->active];
+        size_t length = proof->pending;
+        LeaveCriticalSection(&proof->lock);
+        TRACE_BEGIN("io:proof");
+        bool written = fwrite(buffer, 1, length, proof->file) == length;
+        TRACE_END("io:proof");
+        EnterCriticalSection(&proof->lock);
+        if (!written) proof->failed = true;
+        proof->pending = 0;
+        WakeAllConditionVariable(&proof->changed);
+    }
+    LeaveCriticalSection(&proof->lock);
+    return 0;
+}
+
+// Function to open the proof file and start the writer thread
+bool proof_open(ProofWriter *proof, const char *filename, ProofFormat format, Formula *formula) {
+    memset(proof, 0, sizeof(*proof));
+    proof->file = fopen(filename, "wb");
+    if (!proof->file) {
+        printf("Error: Unable to create proof file %s\n", filename);
+        return false;
+    }
+    proof->buffers[0] = malloc(PROOF_BUFFER_SIZE);
+    proof->buffers[1] = malloc(PROOF_BUFFER_SIZE);
+    if (!proof->buffers[0] || !proof->buffers[1]) {
+        printf("Error: Not enough memory for the proof buffers\n");
+        free(proof->buffers[0]);
+        free(proof->buffers[1]);
+        fclose(proof->file);
+        return false;
+    }
+    proof->format = format;
+    proof->formula = formula;
+    InitializeCriticalSection(&proof->lock);
+    InitializeConditionVariable(&proof->changed);
+    proof->thread = CreateThread(NULL, 0, proof_writer_thread, proof, 0, NULL);
+    if (!proof->thread) {
+        printf("Error: Unable to start the proof writer thread\n");
+        DeleteCriticalSection(&proof->lock);
+        free(proof->buffers[0]);
+        free(proof->buffers[1]);
+        fclose(proof->file);
+        return false;
+    }
+    return true;
+}
+
+// Function to hand the filled buffer to the writer thread and continue in the other one
+static void proof_swap(ProofWriter *proof) {
+    EnterCriticalSection(&proof->lock);
+    while (proof->pending != 0) {
+        SleepConditionVariableCS(&proof->changed, &proof->lock, INFINITE);
+    }
+    proof->pending = proof->length;
+    proof->active = 1 - proof->active;
+    proof->length = 0;
+    WakeAllConditionVariable(&proof->changed);
+    LeaveCriticalSection(&proof->lock);
+}
+
+// Function to append a number in the 7-bit variable-length encoding of binary DRAT/LRAT
+static void proof_put_number(ProofWriter *proof, uint64_t value) {
+    if (proof->length + 10 > PROOF_BUFFER_SIZE) proof_swap(proof);
+    unsigned char *out = proof->buffers[proof->active] + proof->length;
+    while (value > 127) {
+        *out++ = (unsigned char)(128 | (value & 127));
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+    proof->bytes += out - (proof->buffers[proof->active] + proof->length);
+    proof->length = out - proof->buffers[proof->active];
+}
+
+// Function to log a derived clause with the ids of its two parents
+void proof_add(ProofWriter *proof, int id, Clause *clause, int parent1, int parent2) {
+    proof_put_number(proof, 'a');
+    if (proof->format == PROOF_LRAT) proof_put_number(proof, 2 * (uint64_t)id);
+    for (int i = 0; i < clause->num_literals; i++) {
+        int var = find_variable(proof->formula, clause->literals[i].var.name);
+        proof_put_number(proof, 2 * (uint64_t)(var + 1) + clause->literals[i].is_negated);
+    }
+    proof_put_number(proof, 0);
+    if (proof->format == PROOF_LRAT) {
+        proof_put_number(proof, 2 * (uint64_t)parent1);
+        proof_put_number(proof, 2 * (uint64_t)parent2);
+        proof_put_number(proof, 0);
+    }
+    proof->steps++;
+}
+
+// Function to flush the proof and stop the writer thread, returns false if any write failed
+bool proof_close(ProofWriter *proof) {
+    proof_swap(proof);
+    EnterCriticalSection(&proof->lock);
+    proof->closing = true;
+    WakeAllConditionVariable(&proof->changed);
+    LeaveCriticalSection(&proof->lock);
+    WaitForSingleObject(proof->thread, INFINITE);
+    CloseHandle(proof->thread);
+    DeleteCriticalSection(&proof->lock);
+    
+    bool ok = !proof->failed;
+    if (fclose(proof->file) != 0) ok = false;
+    free(proof->buffers[0]);
+    free(proof->buffers[1]);
+    return ok;
+}
+
+// Function to append a clause to the working set, taking ownership of it
+static bool push_work_clause(Clause **work_clauses, int *work_size, int *work_capacity,
+                             Clause *clause, SolverStats *stats) {
+    if (*work_size >= *work_capacity) {
+        int new_capacity = *work_capacity * GROWTH_FACTOR;
+        Clause *new_work = realloc(*work_clauses, new_capacity * sizeof(Clause));
+        if (!new_work) return false;
+        stats->memory += (size_t)(new_capacity - *work_capacity) * sizeof(Clause);
+        *work_clauses = new_work;
+        *work_capacity = new_capacity;
+    }
+    stats->memory += shrink_clause(clause);
+    (*work_clauses)[(*work_size)++] = *clause;
+    stats->clauses = *work_size;
+    if (stats->clauses > stats->max_clauses) stats->max_clauses = stats->clauses;
+    return true;
+}
+
+// Function to find the literal of a clause whose variable comes latest in the formula
+static int maximal_literal(Formula *ordering, Clause *clause) {
+    int best = 0, best_var = -1;
+    for (int k = 0; k < clause->num_literals; k++) {
+        int var = find_variable(ordering, clause->literals[k].var.name);
+        if (var > best_var) {
+            best_var = var;
+            best = k;
+        }
+    }
+    return best;
+}
+
+// Function to add the new resolvents of work clauses i and j to the working set
+// With an ordering, only the maximal literals of both clauses may clash (ordered resolution)
+// Resolvents with more than max_width literals are discarded (0 = no limit)
+// Returns true when the empty clause is derived; failures are recorded in stats->stop_reason
+static bool resolve_pair(Clause **work_clauses, int *work_size, int *work_capacity, int i, int j,
+                         Formula *ordering, int max_width, Budget *budget, SolverStats *stats) {
+    int first = 0, last = (*work_clauses)[i].num_literals;
+    if (ordering) {
+        first = maximal_literal(ordering, &(*work_clauses)[i]);
+        last = first + 1;
+        int other = maximal_literal(ordering, &(*work_clauses)[j]);
+        if (strcmp((*work_clauses)[i].literals[first].var.name, (*work_clauses)[j].literals[other].var.name) != 0) {
+            return false;
+        }
+    }
+    
+    // Try each literal in clause i
+    for (int k = first; k < last; k++) {
+        const char *var = (*work_clauses)[i].literals[k].var.name;
+        bool is_negated = (*work_clauses)[i].literals[k].is_negated;
+        
+        // Look for complementary literal
+        if (clause_contains(&(*work_clauses)[j], var, !is_negated)) {
+            Clause resolvant;
+            stats->clashes++;
+            if (!resolve(&(*work_clauses)[i], &(*work_clauses)[j], var, is_negated, &resolvant)) {
+                if (!resolvant.literals) {
+                    stats->stop_reason = STOP_OUT_OF_MEMORY;
+                    return false;
+                }
+                stats->tautologies++;
+                free_clause(&resolvant);
+                continue;
+            }
+            
+            if (max_width > 0 && resolvant.num_literals > max_width) {
+                stats->too_wide++;
+                free_clause(&resolvant);
+                continue;
+            }
+            
+            if (is_empty_clause(&resolvant)) {
+                if (proof_log) proof_add(proof_log, *work_size + 1, &resolvant, i + 1, j + 1);
+                free_clause(&resolvant);
+                return true;
+            }
+            
+            // Check if this is a new clause
+            bool is_new = true;
+            for (int m = 0; m < *work_size; m++) {
+                if (clauses_equal(&(*work_clauses)[m], &resolvant)) {
+                    is_new = false;
+                    break;
+                }
+            }
+            
+            if (!is_new) {
+                stats->duplicates++;
+                free_clause(&resolvant);
+                continue;
+            }
+            if (!push_work_clause(work_clauses, work_size, work_capacity, &resolvant, stats)) {
+                free_clause(&resolvant);
+                stats->stop_reason = STOP_OUT_OF_MEMORY;
+                return false;
+            }
+            stats->kept++;
+            (*work_clauses)[*work_size - 1].parents[0] = i + 1;
+            (*work_clauses)[*work_size - 1].parents[1] = j + 1;
+            if (proof_log) proof_add(proof_log, *work_size, &(*work_clauses)[*work_size - 1], i + 1, j + 1);
+            if (budget->max_clauses > 0 && *work_size > budget->max_clauses) {
+                stats->stop_reason = STOP_CLAUSE_LIMIT;
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+// Function to check whether literal k of a clause already occurs earlier in it
+static bool repeats_literal(Clause *clause, int k) {
+    for (int m = 0; m < k; m++) {
+        if (clause->literals[m].is_negated == clause->literals[k].is_negated &&
+            strcmp(clause->literals[m].var.name, clause->literals[k].var.name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Function to build a model of a saturated clause set, deciding variables in order
+// Clause c holds the distinct literal codes codes[clause_start[c] .. clause_start[c + 1])
+// Saturation guarantees a value that falsifies no clause: if both values did, the resolvent of the
+// two falsified clauses would be falsified already, and it is in the set
+static bool decide_model(int num_variables, int *clause_start, int *codes, int num_clauses, bool prefer_true,
+                         bool *model) {
+    int num_codes = 2 * num_variables;
+    int total = clause_start[num_clauses];
+    
+    // Occurrence lists: the clauses of literal code l are occurs[start[l] .. start[l + 1])
+    int *start = calloc(num_codes + 1, sizeof(int));
+    int *occurs = malloc((total > 0 ? total : 1) * sizeof(int));
+    int *false_count = calloc(num_clauses > 0 ? num_clauses : 1, sizeof(int));
+    char *satisfied = calloc(num_clauses > 0 ? num_clauses : 1, 1);
+    bool ok = start && occurs && false_count && satisfied;
+    for (int i = 0; ok && i < total; i++) start[codes[i]]++;
+    for (int l = 1; ok && l < num_codes; l++) start[l] += start[l - 1];
+    if (ok) start[num_codes] = num_codes > 0 ? start[num_codes - 1] : 0;
+    for (int c = num_clauses - 1; ok && c >= 0; c--) {
+        for (int i = clause_start[c]; i < clause_start[c + 1]; i++) occurs[--start[codes[i]]] = c;
+    }
+    
+    for (int v = 0; ok && v < num_variables; v++) {
+        // Try the preferred value first: it falsifies the unsatisfied clauses whose only open literal is
+        // the opposite literal of v
+        int positive = 2 * v, negative = 2 * v + 1;
+        int opposite = prefer_true ? negative : positive;
+        bool value = prefer_true;
+        for (int i = start[opposite]; i < start[opposite + 1]; i++) {
+            int c = occurs[i];
+            if (!satisfied[c] && false_count[c] == clause_start[c + 1] - clause_start[c] - 1) {
+                value = !prefer_true;
+                break;
+            }
+        }
+        model[v] = value;
+        int true_code = value ? positive : negative;
+        for (int i = start[true_code]; i < start[true_code + 1]; i++) satisfied[occurs[i]] = 1;
+        for (int i = start[true_code ^ 1]; i < start[(true_code ^ 1) + 1]; i++) false_count[occurs[i]]++;
+    }
+    
+    free(start);
+    free(occurs);
+    free(false_count);
+    free(satisfied);
+    return ok;
+}
+
+// Function to build a model of a saturated working set, deciding variables in formula order
+// A repeated literal is listed once, so a clause like (v2 | v2) is seen as forcing v2
+static bool build_model(Formula *formula, Clause *clauses, int num_clauses, bool prefer_true, bool *model) {
+    int total = 0;
+    for (int c = 0; c < num_clauses; c++) total += clauses[c].num_literals;
+    int *clause_start = malloc(((size_t)num_clauses + 1) * sizeof(int));
+    int *codes = malloc((total > 0 ? total : 1) * sizeof(int));
+    bool ok = clause_start && codes;
+    int size = 0;
+    for (int c = 0; ok && c < num_clauses; c++) {
+        clause_start[c] = size;
+        for (int k = 0; k < clauses[c].num_literals; k++) {
+            if (!repeats_literal(&clauses[c], k)) codes[size++] = literal_code(formula, &clauses[c].literals[k]);
+        }
+    }
+    if (ok) {
+        clause_start[num_clauses] = size;
+        ok = decide_model(formula->num_variables, clause_start, codes, num_clauses, prefer_true, model);
+    }
+    free(clause_start);
+    free(codes);
+    return ok;
+}
+
+// Function to check a model against every clause of the formula
+bool verify_model(Formula *formula, bool *model) {
+    for (int c = 0; c < formula->num_clauses; c++) {
+        Clause *clause = &formula->clauses[c];
+        bool satisfied = false;
+        for (int k = 0; k < clause->num_literals && !satisfied; k++) {
+            int var = find_variable(formula, clause->literals[k].var.name);
+            satisfied = var >= 0 && model[var] != clause->literals[k].is_negated;
+        }
+        if (!satisfied) return false;
+    }
+    return true;
+}
+
+// Function to print a model as named literals on one line
+void print_model(FILE *out, Formula *formula, bool *model) {
+    fprintf(out, "Model:");
+    for (int v = 0; v < formula->num_variables; v++) {
+        fprintf(out, " %s%s", model[v] ? "" : "!", formula->variables[v].name);
+    }
+    fprintf(out, "\n");
+}
+
+/*
+ * Lemma store
+ *
+ * With --lemmas <file>, short resolvents outlive the run that derived them. A
+ * lemma is stored together with its support: the input clauses its derivation
+ * starts from, found by walking the parents back. Clauses are identified by a
+ * 128-bit hash of their literal names, independent of literal order and of
+ * variable numbering, and lemmas sharing a support are grouped under the hash
+ * of that support. A later run imports a group only when every clause of its
+ * support is among its own input clauses, so whatever it imports is implied by
+ * the formula it solves. Imported lemmas join the working set right after the
+ * input clauses, sparing the rounds that derived them; resolvents of imported
+ * lemmas are stored in turn, with the support of those lemmas merged in.
+ *
+ * The file holds a magic string, then each group: its support size and lemma
+ * count (uint32), the support hashes, and each lemma as a literal count
+ * (uint32) followed by its literals (negated flag, name length, name bytes).
+ */
+
+#define LEMMA_MAGIC "LSLEMMA1"
+#define LEMMA_MAX_LENGTH 3         // Longest resolvent stored
+#define LEMMA_MAX_SUPPORT 1024     // Most input clauses a stored lemma may depend on
+#define LEMMA_MAX_VISITS 100000    // Derivation steps walked per lemma to collect its support
+#define LEMMA_MAX_EXPORT 10000     // Lemmas added to the store by one run
+#define LEMMA_MAX_STORED 200000    // Lemmas the store keeps
+
+typedef struct {
+    uint64_t h[2];
+} LemmaKey;
+
+// Open-addressing table entry from a key to an index (value = index + 1, 0 = empty)
+typedef struct {
+    LemmaKey key;
+    int value;
+} LemmaSlot;
+
+typedef struct {
+    int support_start;  // Into the support hashes of the store
+    int support_size;
+    bool present;       // Every support clause is an input clause of the formula being solved
+} LemmaGroup;
+
+typedef struct {
+    char path[MAX_PATH];
+    LemmaGroup *groups;
+    int num_groups;
+    int groups_capacity;
+    LemmaKey *support;
+    int support_size;
+    int support_capacity;
+    Clause *lemmas;
+    int *lemma_group;
+    int num_lemmas;
+    int lemmas_capacity;
+    LemmaSlot *lemma_index;   // Lemma hash -> lemma
+    int lemma_index_capacity;
+    LemmaSlot *group_index;   // Support hash -> group
+    int group_index_capacity;
+    LemmaSlot *input_index;   // Clause hash -> input clause of the formula being solved
+    int input_index_capacity;
+    LemmaKey *input_keys;     // Hash of each input clause
+    int num_inputs;
+    int *imported;            // Lemma pushed at each working set index after the inputs
+    int num_imported;
+    bool failed;              // Memory ran out while exporting, the store misses lemmas
+} LemmaStore;
+
+static LemmaStore *lemma_store = NULL;  // Lemmas imported and exported by the solver, NULL when off
+
+// Function to hash a literal into two independent 64-bit lanes
+static void lemma_hash_literal(const char *name, bool is_negated, uint64_t h[2]) {
+    h[0] = 0xCBF29CE484222325ULL;
+    h[1] = 0x6C62272E07BB0142ULL;
+    for (const unsigned char *c = (const unsigned char *)name; *c; c++) {
+        h[0] = (h[0] ^ *c) * 0x100000001B3ULL;
+        h[1] = (h[1] ^ *c) * 0x9E3779B97F4A7C15ULL;
+    }
+    for (int lane = 0; lane < 2; lane++) {
+        h[lane] ^= is_negated ? 0xA5A5A5A5A5A5A5A5ULL : 0;
+        h[lane] ^= h[lane] >> 33;
+        h[lane] *= lane ? 0xC4CEB9FE1A85EC53ULL : 0xFF51AFD7ED558CCDULL;
+        h[lane] ^= h[lane] >> 33;
+    }
+}
+
+// Function to hash a clause as the sum of its distinct literals, so literal order does not matter
+static LemmaKey lemma_clause_key(Clause *clause) {
+    LemmaKey key = {{(uint64_t)0x51ED27ULL, (uint64_t)0x27D4EB2FULL}};
+    for (int k = 0; k < clause->num_literals; k++) {
+        if (repeats_literal(clause, k)) continue;
+        uint64_t h[2];
+        lemma_hash_literal(clause->literals[k].var.name, clause->literals[k].is_negated, h);
+        key.h[0] += h[0];
+        key.h[1] += h[1];
+    }
+    return key;
+}
+
+// Function to order two hashes
+static int compare_lemma_keys(const void *a, const void *b) {
+    const LemmaKey *x = a, *y = b;
+    if (x->h[0] != y->h[0]) return x->h[0] < y->h[0] ? -1 : 1;
+    if (x->h[1] != y->h[1]) return x->h[1] < y->h[1] ? -1 : 1;
+    return 0;
+}
+
+// Function to find the slot of a key in a table, or the empty slot where it would go
+static int lemma_slot(LemmaSlot *table, int capacity, LemmaKey key) {
+    int slot = (int)(key.h[0] & (uint64_t)(capacity - 1));
+    while (table[slot].value != 0 && compare_lemma_keys(&table[slot].key, &key) != 0) {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    return slot;
+}
+
+// Function to look up a key in a table, returns its index or -1
+static int lemma_find(LemmaSlot *table, int capacity, LemmaKey key) {
+    return capacity > 0 ? table[lemma_slot(table, capacity, key)].value - 1 : -1;
+}
+
+// Function to add a key to a table holding count entries, doubling it to stay at most half full
+static bool lemma_insert(LemmaSlot **table, int *capacity, int count, LemmaKey key, int index) {
+    if ((count + 1) * 2 > *capacity) {
+        int new_capacity = *capacity > 0 ? *capacity * GROWTH_FACTOR : 1024;
+        LemmaSlot *new_table = calloc(new_capacity, sizeof(LemmaSlot));
+        if (!new_table) return false;
+        for (int s = 0; s < *capacity; s++) {
+            if ((*table)[s].value != 0) new_table[lemma_slot(new_table, new_capacity, (*table)[s].key)] = (*table)[s];
+        }
+        free(*table);
+        *table = new_table;
+        *capacity = new_capacity;
+    }
+    int slot = lemma_slot(*table, *capacity, key);
+    (*table)[slot].key = key;
+    (*table)[slot].value = index + 1;
+    return true;
+}
+
+// Function to add a group for a sorted support, or find the group already holding it
+static int lemma_group_for(LemmaStore *store, LemmaKey *support, int size) {
+    LemmaKey fingerprint = {{0x9E3779B97F4A7C15ULL ^ (uint64_t)size, (uint64_t)size}};
+    for (int s = 0; s < size; s++) {
+        fingerprint.h[0] = (fingerprint.h[0] ^ support[s].h[0]) * 0x100000001B3ULL;
+        fingerprint.h[1] = (fingerprint.h[1] ^ support[s].h[1]) * 0x9E3779B97F4A7C15ULL;
+    }
+    int group = lemma_find(store->group_index, store->group_index_capacity, fingerprint);
+    if (group >= 0) return group;
+    
+    if (store->num_groups >= store->groups_capacity) {
+        int new_capacity = store->groups_capacity > 0 ? store->groups_capacity * GROWTH_FACTOR : INITIAL_CAPACITY;
+        LemmaGroup *new_groups = realloc(store->groups, new_capacity * sizeof(LemmaGroup));
+        if (!new_groups) return -1;
+        store->groups = new_groups;
+        store->groups_capacity = new_capacity;
+    }
+    if (store->support_size + size > store->support_capacity) {
+        int new_capacity = (store->support_size + size) * GROWTH_FACTOR;
+        LemmaKey *new_support = realloc(store->support, new_capacity * sizeof(LemmaKey));
+        if (!new_support) return -1;
+        store->support = new_support;
+        store->support_capacity = new_capacity;
+    }
+    if (!lemma_insert(&store->group_index, &store->group_index_capacity, store->num_groups, fingerprint,
+                      store->num_groups)) {
+        return -1;
+    }
+    memcpy(store->support + store->support_size, support, size * sizeof(LemmaKey));
+    LemmaGroup *added = &store->groups[store->num_groups];
+    added->support_start = store->support_size;
+    added->support_size = size;
+    added->present = false;
+    store->support_size += size;
+    return store->num_groups++;
+}
+
+// Function to add a lemma to a group, taking ownership of the clause; a lemma already stored is freed
+static bool lemma_add(LemmaStore *store, Clause *lemma, int group) {
+    LemmaKey key = lemma_clause_key(lemma);
+    if (lemma_find(store->lemma_index, store->lemma_index_capacity, key) >= 0) {
+        free_clause(lemma);
+        return true;
+    }
+    if (store->num_lemmas >= store->lemmas_capacity) {
+        int new_capacity = store->lemmas_capacity > 0 ? store->lemmas_capacity * GROWTH_FACTOR : INITIAL_CAPACITY;
+        Clause *new_lemmas = realloc(store->lemmas, new_capacity * sizeof(Clause));
+        if (!new_lemmas) return false;
+        store->lemmas = new_lemmas;
+        int *new_groups = realloc(store->lemma_group, new_capacity * sizeof(int));
+        if (!new_groups) return false;
+        store->lemma_group = new_groups;
+        store->lemmas_capacity = new_capacity;
+    }
+    if (!lemma_insert(&store->lemma_index, &store->lemma_index_capacity, store->num_lemmas, key,
+                      store->num_lemmas)) {
+        return false;
+    }
+    shrink_clause(lemma);
+    store->lemmas[store->num_lemmas] = *lemma;
+    store->lemma_group[store->num_lemmas++] = group;
+    return true;
+}
+
+// Function to free the lemma store
+void lemma_free(LemmaStore *store) {
+    for (int l = 0; l < store->num_lemmas; l++) free_clause(&store->lemmas[l]);
+    free(store->groups);
+    free(store->support);
+    free(store->lemmas);
+    free(store->lemma_group);
+    free(store->lemma_index);
+    free(store->group_index);
+    free(store->input_index);
+    free(store->input_keys);
+    free(store->imported);
+    memset(store, 0, sizeof(*store));
+}
+
+// Function to read a uint32 of the store file
+static bool lemma_read_count(FILE *file, uint32_t *value, uint32_t limit) {
+    return fread(value, sizeof(*value), 1, file) == 1 && *value <= limit;
+}
+
+// Function to read the store file into the store, a missing file being an empty store
+static bool lemma_read(LemmaStore *store, FILE *file) {
+    char magic[8];
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic)) return feof(file) && !ferror(file);
+    if (memcmp(magic, LEMMA_MAGIC, sizeof(magic)) != 0) return false;
+    
+    LemmaKey *support = malloc(LEMMA_MAX_SUPPORT * sizeof(LemmaKey));
+    bool ok = support != NULL;
+    uint32_t support_size, num_lemmas;
+    while (ok && fread(&support_size, sizeof(support_size), 1, file) == 1) {
+        ok = support_size <= LEMMA_MAX_SUPPORT && lemma_read_count(file, &num_lemmas, LEMMA_MAX_STORED) &&
+             fread(support, sizeof(LemmaKey), support_size, file) == support_size;
+        int group = ok ? lemma_group_for(store, support, (int)support_size) : -1;
+        ok = group >= 0;
+        for (uint32_t l = 0; ok && l < num_lemmas; l++) {
+            uint32_t num_literals;
+            Clause lemma;
+            ok = lemma_read_count(file, &num_literals, LEMMA_MAX_LENGTH) && num_literals > 0 && init_clause(&lemma);
+            for (uint32_t k = 0; ok && k < num_literals; k++) {
+                unsigned char header[2];
+                char name[MAX_VAR_NAME];
+                ok = fread(header, 1, 2, file) == 2 && header[1] > 0 && header[1] < MAX_VAR_NAME &&
+                     fread(name, 1, header[1], file) == header[1];
+                if (ok) {
+                    name[header[1]] = '\0';
+                    ok = add_literal(&lemma, name, header[0] != 0);
+                }
+                if (!ok) free_clause(&lemma);
+            }
+            if (ok && !lemma_add(store, &lemma, group)) {
+                free_clause(&lemma);
+                ok = false;
+            }
+        }
+    }
+    free(support);
+    return ok && !ferror(file);
+}
+
+// Function to open the lemma store and find the groups whose support lies in the formula about to be solved
+bool lemma_open(LemmaStore *store, const char *filename, Formula *formula) {
+    memset(store, 0, sizeof(*store));
+    if (strlen(filename) >= MAX_PATH) {
+        printf("Error: Lemma file name %s is too long\n", filename);
+        return false;
+    }
+    strcpy(store->path, filename);
+    
+    // The store is only written at the end, so an unwritable location is reported before solving
+    char temporary[MAX_PATH + 8];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", filename);
+    FILE *probe = fopen(temporary, "wb");
+    if (!probe) {
+        printf("Error: Unable to write lemma file %s\n", filename);
+        return false;
+    }
+    fclose(probe);
+    remove(temporary);
+    
+    FILE *file = fopen(filename, "rb");
+    if (file) {
+        bool read = lemma_read(store, file);
+        fclose(file);
+        if (!read) {
+            printf("Error: %s is not a valid lemma file\n", filename);
+            lemma_free(store);
+            return false;
+        }
+    }
+    
+    store->num_inputs = formula->num_clauses;
+    store->input_keys = malloc((formula->num_clauses + 1) * sizeof(LemmaKey));
+    store->imported = malloc((store->num_lemmas + 1) * sizeof(int));
+    bool ok = store->input_keys && store->imported;
+    for (int c = 0; ok && c < formula->num_clauses; c++) {
+        store->input_keys[c] = lemma_clause_key(&formula->clauses[c]);
+        ok = lemma_insert(&store->input_index, &store->input_index_capacity, c, store->input_keys[c], c);
+    }
+    for (int g = 0; ok && g < store->num_groups; g++) {
+        LemmaGroup *group = &store->groups[g];
+        group->present = true;
+        for (int s = 0; s < group->support_size && group->present; s++) {
+            group->present = lemma_find(store->input_index, store->input_index_capacity,
+                                        store->support[group->support_start + s]) >= 0;
+        }
+    }
+    if (!ok) {
+        printf("Error: Not enough memory for the lemma store\n");
+        lemma_free(store);
+    }
+    return ok;
+}
+
+// Function to add the stored lemmas whose support is present to the working set, after the input clauses
+static bool lemma_import(LemmaStore *store, Clause **work_clauses, int *work_size, int *work_capacity,
+                         SolverStats *stats) {
+    for (int l = 0; l < store->num_lemmas; l++) {
+        if (!store->groups[store->lemma_group[l]].present) continue;
+        // A lemma equal to an input clause adds nothing
+        if (lemma_find(store->input_index, store->input_index_capacity, lemma_clause_key(&store->lemmas[l])) >= 0) {
+            continue;
+        }
+        Clause copy;
+        if (!copy_clause(&copy, &store->lemmas[l])) return false;
+        if (!push_work_clause(work_clauses, work_size, work_capacity, &copy, stats)) {
+            free_clause(&copy);
+            return false;
+        }
+        store->imported[store->num_imported++] = l;
+        stats->lemmas_imported++;
+    }
+    return true;
+}
+
+// Function to order export candidates: shortest first, then the latest derived
+static int compare_lemma_candidates(const void *a, const void *b) {
+    const long long *x = a, *y = b;
+    return *x < *y ? -1 : *x > *y;
+}
+
+// Function to collect the sorted, distinct input clause hashes a working set clause derives from
+// Returns the support size, or -1 when it is too large, too costly to find or not known
+static int lemma_support(LemmaStore *store, Clause *work_clauses, int index, int *stack, int *mark, int stamp,
+                         LemmaKey *support) {
+    int top = 0, size = 0, visits = 0;
+    stack[top++] = index;
+    mark[index] = stamp;
+    while (top > 0) {
+        int i = stack[--top];
+        if (++visits > LEMMA_MAX_VISITS) return -1;
+        if (work_clauses[i].parents[0] != 0) {
+            for (int p = 0; p < 2; p++) {
+                int parent = work_clauses[i].parents[p] - 1;
+                if (mark[parent] == stamp) continue;
+                mark[parent] = stamp;
+                stack[top++] = parent;
+            }
+        } else if (i < store->num_inputs) {
+            if (size >= LEMMA_MAX_SUPPORT) return -1;
+            support[size++] = store->input_keys[i];
+        } else if (i < store->num_inputs + store->num_imported) {
+            LemmaGroup *group = &store->groups[store->lemma_group[store->imported[i - store->num_inputs]]];
+            if (size + group->support_size > LEMMA_MAX_SUPPORT) return -1;
+            memcpy(support + size, store->support + group->support_start, group->support_size * sizeof(LemmaKey));
+            size += group->support_size;
+        } else {
+            return -1;  // Not derived from the input clauses of this run
+        }
+    }
+    qsort(support, size, sizeof(LemmaKey), compare_lemma_keys);
+    int distinct = 0;
+    for (int s = 0; s < size; s++) {
+        if (distinct == 0 || compare_lemma_keys(&support[distinct - 1], &support[s]) != 0) support[distinct++] = support[s];
+    }
+    return distinct;
+}
+
+// Function to store the shortest resolvents of a working set together with their support
+// Running out of memory only loses lemmas, so it marks the store instead of stopping the solver
+static void lemma_export(LemmaStore *store, Clause *work_clauses, int work_size, SolverStats *stats) {
+    int first = store->num_inputs + store->num_imported;
+    int num_candidates = 0;
+    long long *candidates = malloc(((work_size > first ? work_size - first : 0) + 1) * sizeof(long long));
+    int *stack = malloc((2 * (size_t)work_size + 1) * sizeof(int));
+    int *mark = calloc(work_size + 1, sizeof(int));
+    LemmaKey *support = malloc(LEMMA_MAX_SUPPORT * sizeof(LemmaKey));
+    bool ok = candidates && stack && mark && support;
+    for (int i = first; ok && i < work_size; i++) {
+        int length = work_clauses[i].num_literals;
+        if (length > 0 && length <= LEMMA_MAX_LENGTH) {
+            candidates[num_candidates++] = (long long)length << 32 | (unsigned)(INT_MAX - i);
+        }
+    }
+    if (ok) qsort(candidates, num_candidates, sizeof(long long), compare_lemma_candidates);
+    
+    int stamp = 0, exported = 0;
+    for (int c = 0; ok && c < num_candidates && exported < LEMMA_MAX_EXPORT &&
+                    store->num_lemmas < LEMMA_MAX_STORED; c++) {
+        int index = INT_MAX - (int)(candidates[c] & 0xFFFFFFFF);
+        LemmaKey key = lemma_clause_key(&work_clauses[index]);
+        if (lemma_find(store->lemma_index, store->lemma_index_capacity, key) >= 0 ||
+            lemma_find(store->input_index, store->input_index_capacity, key) >= 0) {
+            continue;
+        }
+        int size = lemma_support(store, work_clauses, index, stack, mark, ++stamp, support);
+        if (size < 0) continue;
+        int group = lemma_group_for(store, support, size);
+        Clause lemma;
+        ok = group >= 0 && copy_clause(&lemma, &work_clauses[index]);
+        if (!ok) break;
+        lemma.parents[0] = 0;
+        lemma.parents[1] = 0;
+        int before = store->num_lemmas;
+        ok = lemma_add(store, &lemma, group);
+        if (!ok) free_clause(&lemma);
+        if (store->num_lemmas > before) exported++;
+    }
+    stats->lemmas_exported += exported;
+    if (!ok) store->failed = true;
+    free(candidates);
+    free(stack);
+    free(mark);
+    free(support);
+}
+
+// Function to write the store to a temporary file and move it over the store file
+static bool lemma_write(LemmaStore *store) {
+    char temporary[MAX_PATH + 8];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", store->path);
+    FILE *file = fopen(temporary, "wb");
+    if (!file) return false;
+    bool ok = fwrite(LEMMA_MAGIC, 1, 8, file) == 8;
+    
+    // Lemmas are kept in arrival order, so each group gathers its own before it is written
+    int *count = calloc(store->num_groups + 1, sizeof(int));
+    int *order = malloc((store->num_lemmas + 1) * sizeof(int));
+    ok = ok && count && order;
+    for (int l = 0; ok && l < store->num_lemmas; l++) count[store->lemma_group[l] + 1]++;
+    for (int g = 0; ok && g < store->num_groups; g++) count[g + 1] += count[g];
+    for (int l = 0; ok && l < store->num_lemmas; l++) order[count[store->lemma_group[l]]++] = l;
+    for (int g = 0, next = 0; ok && g < store->num_groups; g++) {
+        LemmaGroup *group = &store->groups[g];
+        uint32_t header[2] = {(uint32_t)group->support_size, (uint32_t)(count[g] - next)};
+        if (header[1] == 0) continue;
+        ok = fwrite(header, sizeof(uint32_t), 2, file) == 2 &&
+             fwrite(store->support + group->support_start, sizeof(LemmaKey), group->support_size, file) ==
+                 (size_t)group->support_size;
+        for (; ok && next < count[g]; next++) {
+            Clause *lemma = &store->lemmas[order[next]];
+            uint32_t num_literals = (uint32_t)lemma->num_literals;
+            ok = fwrite(&num_literals, sizeof(num_literals), 1, file) == 1;
+            for (int k = 0; ok && k < lemma->num_literals; k++) {
+                unsigned char literal[2] = {lemma->literals[k].is_negated, (unsigned char)strlen(lemma->literals[k].var.name)};
+                ok = fwrite(literal, 1, 2, file) == 2 &&
+                     fwrite(lemma->literals[k].var.name, 1, literal[1], file) == literal[1];
+            }
+        }
+    }
+    free(count);
+    free(order);
+    if (fclose(file) != 0) ok = false;
+    if (ok) ok = MoveFileExA(temporary, store->path, MOVEFILE_REPLACE_EXISTING) != 0;
+    if (!ok) remove(temporary);
+    return ok;
+}
+
+// Function to save and free the lemma store, returns false if it is incomplete or could not be written
+bool lemma_close(LemmaStore *store) {
+    bool ok = lemma_write(store) && !store->failed;
+    lemma_free(store);
+    return ok;
+}
+
+// Working set of a run that derived the empty clause, kept for core and proof extraction
+typedef struct {
+    Clause *clauses;     // Input clauses first, then resolvents with their parents set
+    int num_clauses;
+    int num_inputs;
+    int parents[2];      // Working set ids of the two clauses resolved into the empty clause
+    char *used;          // Per working set clause, set when the refutation depends on it
+} Refutation;
+
+// Function to order two waiting clauses: shorter first for unit preference, then older first
+static bool given_before(Clause *work_clauses, Strategy strategy, int a, int b) {
+    if (strategy == STRATEGY_UNIT && work_clauses[a].num_literals != work_clauses[b].num_literals) {
+        return work_clauses[a].num_literals < work_clauses[b].num_literals;
+    }
+    return a < b;
+}
+
+// Function to append a clause index to a growing array
+static bool push_index(int **array, int *size, int *capacity, int index) {
+    if (*size >= *capacity) {
+        int new_capacity = *capacity * GROWTH_FACTOR;
+        int *new_array = realloc(*array, new_capacity * sizeof(int));
+        if (!new_array) return false;
+        *array = new_array;
+        *capacity = new_capacity;
+    }
+    (*array)[(*size)++] = index;
+    return true;
+}
+
+// Function to add a clause index to the binary heap of waiting clauses
+static bool push_waiting(int **heap, int *size, int *capacity, int index, Clause *work_clauses, Strategy strategy) {
+    if (!push_index(heap, size, capacity, index)) return false;
+    int pos = *size - 1;
+    while (pos > 0 && given_before(work_clauses, strategy, index, (*heap)[(pos - 1) / 2])) {
+        (*heap)[pos] = (*heap)[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    (*heap)[pos] = index;
+    return true;
+}
+
+// Function to take the first waiting clause from the heap
+static int pop_waiting(int *heap, int *size, Clause *work_clauses, Strategy strategy) {
+    int top = heap[0];
+    int last = heap[--(*size)];
+    int pos = 0;
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && given_before(work_clauses, strategy, heap[child + 1], heap[child])) child++;
+        if (!given_before(work_clauses, strategy, heap[child], last)) break;
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    if (*size > 0) heap[pos] = last;
+    return top;
+}
+
+// Function to check whether an input clause starts in the set of support
+static bool in_goal(Formula *formula, SearchOptions *search, int index) {
+    if (index >= formula->num_clauses) return true;  // Resolvents of an earlier width pass descend from the goal
+    if (search->goal_clauses > 0) return index >= formula->num_clauses - search->goal_clauses;
+    for (int k = 0; k < formula->clauses[index].num_literals; k++) {
+        if (!formula->clauses[index].literals[k].is_negated) return false;
+    }
+    return true;
+}
+
+// Function to saturate with the given-clause loop: each selected clause is resolved with every
+// clause selected before it. With a set of support, only goal clauses and their resolvents are
+// ever selected, and the other input clauses start out as already selected
+// A resume cursor continues the pass of a snapshot instead (NULL to start the pass)
+static bool given_clause_saturation(Formula *formula, SearchOptions *search, int max_width,
+                                    Clause **work_clauses, int *work_size, int *work_capacity,
+                                    Budget *budget, SolverStats *stats, double saturation_start,
+                                    int parents[2], SaturationCursor *resume) {
+    int waiting_capacity = INITIAL_CAPACITY + (resume ? resume->waiting_size : 0), waiting_size = 0;
+    int active_capacity = INITIAL_CAPACITY + (resume ? resume->active_size : 0), active_size = 0;
+    int *waiting = malloc(waiting_capacity * sizeof(int));
+    int *active = malloc(active_capacity * sizeof(int));
+    bool found_empty = false;
+    int given = -1, first = 0;
+    long long pass_too_wide = resume ? resume->pass_too_wide : stats->too_wide;
+    if (!waiting || !active) {
+        stats->stop_reason = STOP_OUT_OF_MEMORY;
+    } else if (resume) {
+        memcpy(waiting, resume->waiting, resume->waiting_size * sizeof(int));
+        memcpy(active, resume->active, resume->active_size * sizeof(int));
+        waiting_size = resume->waiting_size;
+        active_size = resume->active_size;
+        given = resume->given;
+        first = resume->next_active;
+    }
+    
+    for (int i = 0; i < *work_size && !resume && stats->stop_reason == STOP_NONE; i++) {
+        if (search->strategy != STRATEGY_SOS || in_goal(formula, search, i)) {
+            if (!push_waiting(&waiting, &waiting_size, &waiting_capacity, i, *work_clauses, search->strategy)) {
+                stats->stop_reason = STOP_OUT_OF_MEMORY;
+            }
+        } else if (!push_index(&active, &active_size, &active_capacity, i)) {
+            stats->stop_reason = STOP_OUT_OF_MEMORY;
+        }
+    }
+    
+    while ((given >= 0 || waiting_size > 0) && !found_empty && stats->stop_reason == STOP_NONE) {
+        if (given < 0) {
+            given = pop_waiting(waiting, &waiting_size, *work_clauses, search->strategy);
+            stats->given++;
+            first = 0;
+        }
+        TRACE_BEGIN_ARG("given", (*work_clauses)[given].num_literals);
+        
+        for (int a = first; a < active_size && !found_empty && stats->stop_reason == STOP_NONE; a++) {
+            // Checked before the pair is counted, so a snapshot taken here holds the counters it resumes with
+            if ((stats->pairs_tried + 1) % BUDGET_CHECK_INTERVAL == 0) {
+                stats->saturation_time = now_seconds() - saturation_start;
+                TRACE_COUNTER("clauses", *work_size);
+                TRACE_COUNTER("duplicates", stats->duplicates);
+                bool exhausted = budget_exhausted(budget, stats);
+                if (checkpoint_log) {
+                    SaturationCursor cursor = {max_width, pass_too_wide, 0, 0, 0, given, a,
+                                               waiting, waiting_size, active, active_size};
+                    checkpoint_save(checkpoint_log, *work_clauses, *work_size, &cursor, stats, exhausted);
+                }
+                if (exhausted) break;
+            }
+            stats->pairs_tried++;
+            
+            int before = *work_size;
+            found_empty = resolve_pair(work_clauses, work_size, work_capacity, active[a], given, NULL, max_width,
+                                       budget, stats);
+            if (found_empty) {
+                parents[0] = active[a] + 1;
+                parents[1] = given + 1;
+            }
+            for (int r = before; r < *work_size && stats->stop_reason == STOP_NONE; r++) {
+                if (!push_waiting(&waiting, &waiting_size, &waiting_capacity, r, *work_clauses, search->strategy)) {
+                    stats->stop_reason = STOP_OUT_OF_MEMORY;
+                }
+            }
+        }
+        
+        if (stats->stop_reason == STOP_NONE && !push_index(&active, &active_size, &active_capacity, given)) {
+            stats->stop_reason = STOP_OUT_OF_MEMORY;
+        }
+        given = -1;
+        TRACE_END("given");
+    }
+    
+    free(waiting);
+    free(active);
+    return found_empty;
+}
+
+// Function to saturate round by round: each round resolves every pair of the clauses held at its start
+// A resume cursor continues the round of a snapshot first (NULL to start the pass)
+static bool round_saturation(Formula *ordering, int max_width, Clause **work_clauses, int *work_size,
+                             int *work_capacity, Budget *budget, SolverStats *stats,
+                             double saturation_start, int parents[2], SaturationCursor *resume) {
+    bool found_empty = false;
+    int start = 0;
+    long long pass_too_wide = resume ? resume->pass_too_wide : stats->too_wide;
+    while (start < *work_size && !found_empty && stats->stop_reason == STOP_NONE) {
+        int end = resume ? resume->end : *work_size;
+        int first = resume ? resume->i : 0;
+        TRACE_BEGIN_ARG("round", stats->rounds + 1);
+        
+        for (int i = first; i < end && !found_empty && stats->stop_reason == STOP_NONE; i++) {
+            for (int j = resume && i == first ? resume->j : i + 1;
+                 j < end && !found_empty && stats->stop_reason == STOP_NONE; j++) {
+                // Cheap periodic check of the time and memory budgets, made before the pair is counted
+                // so a snapshot taken here holds the counters it resumes with
+                if ((stats->pairs_tried + 1) % BUDGET_CHECK_INTERVAL == 0) {
+                    stats->saturation_time = now_seconds() - saturation_start;
+                    TRACE_COUNTER("clauses", *work_size);
+                    TRACE_COUNTER("duplicates", stats->duplicates);
+                    bool exhausted = budget_exhausted(budget, stats);
+                    if (checkpoint_log) {
+                        SaturationCursor cursor = {max_width, pass_too_wide, end, i, j, -1, 0, NULL, 0, NULL, 0};
+                        checkpoint_save(checkpoint_log, *work_clauses, *work_size, &cursor, stats, exhausted);
+                    }
+                    if (exhausted) break;
+                }
+                stats->pairs_tried++;
+                
+                found_empty = resolve_pair(work_clauses, work_size, work_capacity, i, j, ordering, max_width,
+                                           budget, stats);
+                if (found_empty) {
+                    parents[0] = i + 1;
+                    parents[1] = j + 1;
+                }
+            }
+        }
+        if (stats->stop_reason == STOP_NONE && !found_empty) {
+            stats->rounds++;
+        }
+        TRACE_COUNTER("clauses", *work_size);
+        TRACE_COUNTER("duplicates", stats->duplicates);
+        TRACE_END("round");
+        start = end;
+        resume = NULL;
+    }
+    return found_empty;
+}
+
+/*
+ * ZBDD resolution
+ *
+ * The whole clause set is one zero-suppressed BDD over literal codes, x before
+ * !x and variables in formula order. A node tests one literal: its high edge
+ * continues the clauses that contain it, its low edge the others. Terminal 0 is
+ * the empty family and terminal 1 the family holding only the empty clause.
+ * Clauses sharing a prefix or a suffix share nodes, so sets of millions of
+ * clauses take a few MB. A unique table keeps every node canonical and a
+ * direct-mapped cache memoises the set operations.
+ *
+ * Davis-Putnam elimination then works on sets instead of single clauses. With
+ * F = x.P + !x.N + R, the top variable x is removed by F := R + P x N: the
+ * product joins every pair of a P and an N clause and drops tautologies, and
+ * clauses subsumed by another one are removed afterwards. Deriving the empty
+ * clause refutes the formula, while the empty family proves it satisfiable. P
+ * and N are kept for each variable, so a model is rebuilt backwards: x is true
+ * exactly when a clause of P is false under the values of the later variables.
+ */
+
+#define ZBDD_MIN_CACHE_BITS 16
+#define ZBDD_MAX_CACHE_BITS 22   // The cache grows with the nodes up to 4M entries (64 MB)
+#define ZBDD_STACK_SIZE ((size_t)256 << 20)          // Stack reserved for the thread running the set operations
+#define ZBDD_MAX_DEPTH (int)(ZBDD_STACK_SIZE / 512)  // Deepest recursion allowed, frames stay well under 512 bytes
+#define ZBDD_MIN_COLLECT 100000  // Nodes held before the first garbage collection
+
+enum { ZBDD_UNION, ZBDD_PRODUCT, ZBDD_MINIMAL, ZBDD_NONSUPERSET, ZBDD_FALSIFIED };
+
+typedef struct {
+    int op;
+    int a, b;
+    int result;
+} ZbddCacheEntry;
+
+typedef struct {
+    int *var;            // Literal code tested by each node, INT_MAX for the terminals 0 and 1
+    int *low;
+    int *high;
+    int *next;           // Next node in the same unique-table bucket
+    int num_nodes;
+    int capacity;
+    int *buckets;
+    int num_buckets;
+    ZbddCacheEntry *cache;
+    int cache_size;      // Power of two
+    int depth;
+    bool failed;         // Out of memory or recursion too deep; results are meaningless from then on
+    bool stopped;        // The budget ran out inside an operation, which unwinds without a result
+    Budget *budget;      // Checked every BUDGET_CHECK_INTERVAL recursive steps, NULL for no checks
+    SolverStats *stats;
+    int until_check;
+} Zbdd;
+
+// Function to hash a node or an operation into a table of 2^k entries
+static unsigned zbdd_hash(int a, int b, int c, int mask) {
+    uint64_t h = (uint64_t)(unsigned)a * 0x9E3779B97F4A7C15ULL;
+    h = (h ^ (unsigned)b) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (unsigned)c) * 0x94D049BB133111EBULL;
+    return (unsigned)(h >> 32) & (unsigned)mask;
+}
+
+// Function to rebuild the unique table with room for the nodes held
+static bool zbdd_rehash(Zbdd *z, int num_buckets) {
+    int *buckets = malloc(num_buckets * sizeof(int));
+    if (!buckets) return false;
+    for (int b = 0; b < num_buckets; b++) buckets[b] = -1;
+    for (int n = 2; n < z->num_nodes; n++) {
+        unsigned b = zbdd_hash(z->var[n], z->low[n], z->high[n], num_buckets - 1);
+        z->next[n] = buckets[b];
+        buckets[b] = n;
+    }
+    free(z->buckets);
+    z->buckets = buckets;
+    z->num_buckets = num_buckets;
+    return true;
+}
+
+// Function to initialise a ZBDD manager holding only the terminals
+static bool zbdd_init(Zbdd *z) {
+    memset(z, 0, sizeof(*z));
+    z->capacity = INITIAL_CAPACITY;
+    z->var = malloc(z->capacity * sizeof(int));
+    z->low = malloc(z->capacity * sizeof(int));
+    z->high = malloc(z->capacity * sizeof(int));
+    z->next = malloc(z->capacity * sizeof(int));
+    z->cache_size = 1 << ZBDD_MIN_CACHE_BITS;
+    z->cache = calloc(z->cache_size, sizeof(ZbddCacheEntry));
+    if (!z->var || !z->low || !z->high || !z->next || !z->cache) return false;
+    for (int n = 0; n < 2; n++) {
+        z->var[n] = INT_MAX;
+        z->low[n] = z->high[n] = n;
+    }
+    z->num_nodes = 2;
+    return zbdd_rehash(z, INITIAL_CAPACITY);
+}
+
+// Function to free a ZBDD manager
+static void zbdd_free(Zbdd *z) {
+    free(z->var);
+    free(z->low);
+    free(z->high);
+    free(z->next);
+    free(z->buckets);
+    free(z->cache);
+}
+
+// Function to find or create the node testing var, dropping it when its high edge is the empty family
+static int zbdd_node(Zbdd *z, int var, int low, int high) {
+    if (high == 0 || z->failed || z->stopped) return low;
+    unsigned b = zbdd_hash(var, low, high, z->num_buckets - 1);
+    for (int n = z->buckets[b]; n >= 0; n = z->next[n]) {
+        if (z->var[n] == var && z->low[n] == low && z->high[n] == high) return n;
+    }
+    if (z->num_nodes >= z->capacity) {
+        // Each array is stored as soon as it moved, so a failure leaves none of them freed
+        int new_capacity = z->capacity * GROWTH_FACTOR;
+        int **arrays[4] = {&z->var, &z->low, &z->high, &z->next};
+        for (int k = 0; k < 4; k++) {
+            int *grown = realloc(*arrays[k], new_capacity * sizeof(int));
+            if (!grown) {
+                z->failed = true;
+                return 0;
+            }
+            *arrays[k] = grown;
+        }
+        z->capacity = new_capacity;
+    }
+    int n = z->num_nodes++;
+    z->var[n] = var;
+    z->low[n] = low;
+    z->high[n] = high;
+    z->next[n] = z->buckets[b];
+    z->buckets[b] = n;
+    if (z->num_nodes > 2 * z->num_buckets && !zbdd_rehash(z, 2 * z->num_buckets)) z->failed = true;
+    
+    // A cache much smaller than the nodes thrashes, and every lost result is computed again
+    if (z->num_nodes > z->cache_size && z->cache_size < 1 << ZBDD_MAX_CACHE_BITS) {
+        ZbddCacheEntry *cache = calloc(2 * (size_t)z->cache_size, sizeof(ZbddCacheEntry));
+        if (cache) {
+            free(z->cache);
+            z->cache = cache;
+            z->cache_size *= 2;
+        }
+    }
+    return n;
+}
+
+// Function to look up the slot of a memoised operation
+// Creating nodes may grow the cache, so results are stored through a fresh lookup
+static ZbddCacheEntry *zbdd_cached(Zbdd *z, int op, int a, int b) {
+    return &z->cache[zbdd_hash(op, a, b, z->cache_size - 1)];
+}
+
+// Function to get the bytes held by a ZBDD manager
+static size_t zbdd_memory(Zbdd *z) {
+    return (size_t)z->capacity * 4 * sizeof(int) + (size_t)z->num_buckets * sizeof(int) +
+           (size_t)z->cache_size * sizeof(ZbddCacheEntry);
+}
+
+// Function to enter a recursive operation, false once the stack bound, the budget or an earlier failure stops it
+// A single product can run for minutes, so the budget is checked here rather than between eliminations
+static bool zbdd_enter(Zbdd *z) {
+    if (++z->depth > ZBDD_MAX_DEPTH) z->failed = true;
+    if (z->budget && --z->until_check <= 0) {
+        z->until_check = BUDGET_CHECK_INTERVAL;
+        z->stats->memory = zbdd_memory(z);
+        if (budget_exhausted(z->budget, z->stats)) z->stopped = true;
+    }
+    return !z->failed && !z->stopped;
+}
+
+// Function to check whether a family holds the empty clause
+static bool zbdd_has_empty(Zbdd *z, int a) {
+    while (a > 1) a = z->low[a];
+    return a == 1;
+}
+
+// Function to split a family on variable v into the clauses with v, with !v (both without it) and the rest
+static void zbdd_split(Zbdd *z, int a, int v, int *positive, int *negative, int *rest) {
+    *positive = *negative = 0;
+    if (z->var[a] == 2 * v) {
+        *positive = z->high[a];
+        a = z->low[a];
+    }
+    if (z->var[a] == 2 * v + 1) {
+        *negative = z->high[a];
+        a = z->low[a];
+    }
+    *rest = a;
+}
+
+// Function to compute the union of two families
+static int zbdd_union(Zbdd *z, int a, int b) {
+    if (a == 0 || a == b) return b;
+    if (b == 0) return a;
+    if (a > b) {
+        int t = a;
+        a = b;
+        b = t;
+    }
+    ZbddCacheEntry *entry = zbdd_cached(z, ZBDD_UNION, a, b);
+    if (entry->op == ZBDD_UNION && entry->a == a && entry->b == b) return entry->result;
+    int result = 0;
+    if (zbdd_enter(z)) {
+        if (z->var[a] < z->var[b]) {
+            result = zbdd_node(z, z->var[a], zbdd_union(z, z->low[a], b), z->high[a]);
+        } else if (z->var[a] > z->var[b]) {
+            result = zbdd_node(z, z->var[b], zbdd_union(z, a, z->low[b]), z->high[b]);
+        } else {
+            int low = zbdd_union(z, z->low[a], z->low[b]);
+            result = zbdd_node(z, z->var[a], low, zbdd_union(z, z->high[a], z->high[b]));
+        }
+    }
+    z->depth--;
+    if (z->failed || z->stopped) return 0;
+    *zbdd_cached(z, ZBDD_UNION, a, b) = (ZbddCacheEntry){ZBDD_UNION, a, b, result};
+    return result;
+}
+
+// Function to join every clause of a with every clause of b, leaving out tautologies
+// Both literals of the top variable are split off together, so x and !x never meet
+static int zbdd_product(Zbdd *z, int a, int b) {
+    if (a == 0 || b == 0) return 0;
+    if (a == 1) return b;
+    if (b == 1) return a;
+    if (a > b) {
+        int t = a;
+        a = b;
+        b = t;
+    }
+    ZbddCacheEntry *entry = zbdd_cached(z, ZBDD_PRODUCT, a, b);
+    if (entry->op == ZBDD_PRODUCT && entry->a == a && entry->b == b) return entry->result;
+    int result = 0;
+    if (zbdd_enter(z)) {
+        int v = (z->var[a] < z->var[b] ? z->var[a] : z->var[b]) / 2;
+        int a_positive, a_negative, a_rest, b_positive, b_negative, b_rest;
+        zbdd_split(z, a, v, &a_positive, &a_negative, &a_rest);
+        zbdd_split(z, b, v, &b_positive, &b_negative, &b_rest);
+        
+        int positive = zbdd_union(z, zbdd_product(z, a_positive, b_positive), zbdd_product(z, a_positive, b_rest));
+        positive = zbdd_union(z, positive, zbdd_product(z, a_rest, b_positive));
+        int negative = zbdd_union(z, zbdd_product(z, a_negative, b_negative), zbdd_product(z, a_negative, b_rest));
+        negative = zbdd_union(z, negative, zbdd_product(z, a_rest, b_negative));
+        int rest = zbdd_product(z, a_rest, b_rest);
+        result = zbdd_node(z, 2 * v, zbdd_node(z, 2 * v + 1, rest, negative), positive);
+    }
+    z->depth--;
+    if (z->failed || z->stopped) return 0;
+    *zbdd_cached(z, ZBDD_PRODUCT, a, b) = (ZbddCacheEntry){ZBDD_PRODUCT, a, b, result};
+    return result;
+}
+
+// Function to remove from a every clause that contains a clause of b
+static int zbdd_nonsuperset(Zbdd *z, int a, int b) {
+    if (a == 0 || b == 1 || a == b) return 0;
+    if (b == 0) return a;
+    ZbddCacheEntry *entry = zbdd_cached(z, ZBDD_NONSUPERSET, a, b);
+    if (entry->op == ZBDD_NONSUPERSET && entry->a == a && entry->b == b) return entry->result;
+    int result = 0;
+    if (zbdd_enter(z)) {
+        if (z->var[b] < z->var[a]) {
+            // No clause of a holds the top literal of b
+            result = zbdd_nonsuperset(z, a, z->low[b]);
+        } else if (z->var[a] < z->var[b]) {
+            int low = zbdd_nonsuperset(z, z->low[a], b);
+            result = zbdd_node(z, z->var[a], low, zbdd_nonsuperset(z, z->high[a], b));
+        } else {
+            int low = zbdd_nonsuperset(z, z->low[a], z->low[b]);
+            int high = zbdd_nonsuperset(z, zbdd_nonsuperset(z, z->high[a], z->low[b]), z->high[b]);
+            result = zbdd_node(z, z->var[a], low, high);
+        }
+    }
+    z->depth--;
+    if (z->failed || z->stopped) return 0;
+    *zbdd_cached(z, ZBDD_NONSUPERSET, a, b) = (ZbddCacheEntry){ZBDD_NONSUPERSET, a, b, result};
+    return result;
+}
+
+// Function to remove the clauses of a family that another of its clauses subsumes
+static int zbdd_minimal(Zbdd *z, int a) {
+    if (a <= 1) return a;
+    ZbddCacheEntry *entry = zbdd_cached(z, ZBDD_MINIMAL, a, 0);
+    if (entry->op == ZBDD_MINIMAL && entry->a == a) return entry->result;
+    int result = 0;
+    if (zbdd_enter(z)) {
+        int low = zbdd_minimal(z, z->low[a]);
+        result = zbdd_node(z, z->var[a], low, zbdd_nonsuperset(z, zbdd_minimal(z, z->high[a]), low));
+    }
+    z->depth--;
+    if (z->failed || z->stopped) return 0;
+    *zbdd_cached(z, ZBDD_MINIMAL, a, 0) = (ZbddCacheEntry){ZBDD_MINIMAL, a, 0, result};
+    return result;
+}
+
+// Function to check whether some clause of a family is false under the model, stamp tells calls apart
+static bool zbdd_falsified(Zbdd *z, int a, bool *model, int stamp) {
+    if (a <= 1) return a == 1;
+    ZbddCacheEntry *entry = zbdd_cached(z, ZBDD_FALSIFIED, a, stamp);
+    if (entry->op == ZBDD_FALSIFIED && entry->a == a && entry->b == stamp) return entry->result;
+    bool result = false;
+    if (zbdd_enter(z)) {
+        int code = z->var[a];
+        result = zbdd_falsified(z, z->low[a], model, stamp) ||
+                 (model[code / 2] == (code & 1) && zbdd_falsified(z, z->high[a], model, stamp));
+    }
+    z->depth--;
+    if (z->failed || z->stopped) return false;
+    *zbdd_cached(z, ZBDD_FALSIFIED, a, stamp) = (ZbddCacheEntry){ZBDD_FALSIFIED, a, stamp, result};
+    return result;
+}
+
+// Function to keep only the nodes reachable from the roots, renumbering them in place
+// Children are always created before their parents, so one ascending pass renumbers everything
+static bool zbdd_collect(Zbdd *z, int **roots, int num_roots) {
+    char *mark = calloc(z->num_nodes, 1);
+    int *stack = malloc(z->num_nodes * sizeof(int));
+    if (!mark || !stack) {
+        free(mark);
+        free(stack);
+        return false;
+    }
+    mark[0] = mark[1] = 1;
+    for (int r = 0; r < num_roots; r++) {
+        int size = 0;
+        stack[size++] = *roots[r];
+        while (size > 0) {
+            int n = stack[--size];
+            if (mark[n]) continue;
+            mark[n] = 1;
+            stack[size++] = z->low[n];
+            stack[size++] = z->high[n];
+        }
+    }
+    int *renumber = stack;  // Reused: every node is visited once, in ascending order
+    int kept = 0;
+    for (int n = 0; n < z->num_nodes; n++) {
+        if (!mark[n]) continue;
+        z->var[kept] = z->var[n];
+        z->low[kept] = n > 1 ? renumber[z->low[n]] : n;
+        z->high[kept] = n > 1 ? renumber[z->high[n]] : n;
+        renumber[n] = kept++;
+    }
+    for (int r = 0; r < num_roots; r++) *roots[r] = renumber[*roots[r]];
+    z->num_nodes = kept;
+    memset(z->cache, 0, (size_t)z->cache_size * sizeof(ZbddCacheEntry));
+    free(mark);
+    free(stack);
+    return zbdd_rehash(z, z->num_buckets);
+}
+
+// Function to count the clauses of a family, saturating at LLONG_MAX
+static long long zbdd_count(Zbdd *z, int a) {
+    long long *count = malloc((a + 1) * sizeof(long long));
+    if (!count) return 0;
+    count[0] = 0;
+    if (a >= 1) count[1] = 1;
+    for (int n = 2; n <= a; n++) {
+        long long low = count[z->low[n]], high = count[z->high[n]];
+        count[n] = low > LLONG_MAX - high ? LLONG_MAX : low + high;
+    }
+    long long result = count[a];
+    free(count);
+    return result;
+}
+
+// Function to decide a formula by Davis-Putnam elimination on a ZBDD of its clauses
+static SolverResult zbdd_eliminate(Formula *formula, Budget *budget, SolverStats *stats, bool *model) {
+    double phase_start = now_seconds();
+    Zbdd z;
+    int *eliminated = malloc((3 * (size_t)formula->num_variables + 1) * sizeof(int));  // Variable, P and N
+    int **roots = malloc((2 * (size_t)formula->num_variables + 2) * sizeof(int *));
+    int *codes = malloc(INITIAL_CAPACITY * sizeof(int));
+    int codes_capacity = INITIAL_CAPACITY;
+    int *chains = malloc(((size_t)formula->num_clauses + 1) * sizeof(int));
+    bool ok = zbdd_init(&z) && eliminated && roots && codes && chains;
+    int set = 0, num_eliminated = 0, num_chains = 0;
+    z.budget = budget;
+    z.stats = stats;
+    z.until_check = BUDGET_CHECK_INTERVAL;
+    
+    // Each clause is a chain of literal nodes, tautologies are left out
+    TRACE_BEGIN("setup");
+    for (int c = 0; ok && c < formula->num_clauses && !z.failed && !z.stopped; c++) {
+        Clause *clause = &formula->clauses[c];
+        if (clause->num_literals > codes_capacity) {
+            int *grown = realloc(codes, clause->num_literals * sizeof(int));
+            ok = grown != NULL;
+            if (!ok) break;
+            codes = grown;
+            codes_capacity = clause->num_literals;
+        }
+        for (int k = 0; k < clause->num_literals; k++) codes[k] = literal_code(formula, &clause->literals[k]);
+        for (int k = 1; k < clause->num_literals; k++) {
+            int code = codes[k], j = k;
+            for (; j > 0 && codes[j - 1] > code; j--) codes[j] = codes[j - 1];
+            codes[j] = code;
+        }
+        bool tautology = false;
+        int chain = 1;
+        for (int k = clause->num_literals - 1; k >= 0; k--) {
+            if (k > 0 && codes[k - 1] == (codes[k] ^ 1) && (codes[k] & 1)) tautology = true;
+            if (k + 1 < clause->num_literals && codes[k + 1] == codes[k]) continue;
+            chain = zbdd_node(&z, codes[k], 0, chain);
+        }
+        if (!tautology) chains[num_chains++] = chain;
+    }
+    
+    // Unions of balanced pairs, so the partial families stay small and leave little garbage
+    for (int width = 1; ok && width < num_chains; width *= 2) {
+        for (int c = 0; c + width < num_chains; c += 2 * width) {
+            chains[c] = zbdd_union(&z, chains[c], chains[c + width]);
+        }
+    }
+    if (num_chains > 0) set = zbdd_minimal(&z, chains[0]);
+    stats->setup_time = now_seconds() - phase_start;
+    TRACE_END("setup");
+    
+    double saturation_start = now_seconds();
+    TRACE_BEGIN("saturation");
+    SolverResult result = RESULT_UNKNOWN;
+    size_t collected = ZBDD_MIN_COLLECT;
+    while (ok && !z.failed && !z.stopped) {
+        stats->memory = zbdd_memory(&z);
+        if (set == 0) {
+            result = RESULT_SATISFIABLE;
+            break;
+        }
+        if (zbdd_has_empty(&z, set)) {
+            result = RESULT_UNSATISFIABLE;
+            break;
+        }
+        if (budget_exhausted(budget, stats)) break;
+        
+        // A stopped operation returns no family, so the set before this elimination is kept
+        int v = z.var[set] / 2, positive, negative, rest;
+        zbdd_split(&z, set, v, &positive, &negative, &rest);
+        int resolved = zbdd_minimal(&z, zbdd_union(&z, rest, zbdd_product(&z, positive, negative)));
+        if (z.failed || z.stopped) break;
+        eliminated[3 * num_eliminated] = v;
+        eliminated[3 * num_eliminated + 1] = positive;
+        eliminated[3 * num_eliminated + 2] = negative;
+        num_eliminated++;
+        set = resolved;
+        stats->rounds++;
+        
+        // Dead nodes pile up with every elimination: collect once they outnumber the live ones
+        if ((size_t)z.num_nodes > 2 * collected && !z.failed) {
+            int num_roots = 0;
+            roots[num_roots++] = &set;
+            for (int e = 0; e < num_eliminated; e++) {
+                roots[num_roots++] = &eliminated[3 * e + 1];
+                roots[num_roots++] = &eliminated[3 * e + 2];
+            }
+            ok = zbdd_collect(&z, roots, num_roots);
+            collected = z.num_nodes > ZBDD_MIN_COLLECT ? z.num_nodes : ZBDD_MIN_COLLECT;
+            stats->clauses = (int)(zbdd_count(&z, set) > INT_MAX ? INT_MAX : zbdd_count(&z, set));
+            if (stats->clauses > stats->max_clauses) stats->max_clauses = stats->clauses;
+        }
+    }
+    if (!ok || z.failed) {
+        stats->stop_reason = STOP_OUT_OF_MEMORY;
+        result = RESULT_UNKNOWN;
+    }
+    if (ok && !z.failed) {
+        long long count = zbdd_count(&z, set);
+        stats->clauses = (int)(count > INT_MAX ? INT_MAX : count);
+        if (stats->clauses > stats->max_clauses) stats->max_clauses = stats->clauses;
+    }
+    stats->saturation_time = now_seconds() - saturation_start;
+    TRACE_END("saturation");
+    
+    // Later variables first: x is true exactly when a clause x | p has p false
+    if (result == RESULT_SATISFIABLE && model) {
+        TRACE_BEGIN("model");
+        z.budget = NULL;  // The verdict stands, the model only reads the families kept
+        for (int v = 0; v < formula->num_variables; v++) model[v] = false;
+        for (int e = num_eliminated - 1; e >= 0 && !z.failed; e--) {
+            model[eliminated[3 * e]] = zbdd_falsified(&z, eliminated[3 * e + 1], model, e);
+        }
+        if (z.failed) {
+            stats->stop_reason = STOP_OUT_OF_MEMORY;
+            result = RESULT_UNKNOWN;
+        }
+        TRACE_END("model");
+    }
+    
+    zbdd_free(&z);
+    free(eliminated);
+    free(roots);
+    free(codes);
+    free(chains);
+    return result;
+}
+
+// Arguments and result of a ZBDD run on its own thread
+typedef struct {
+    Formula *formula;
+    Budget *budget;
+    SolverStats *stats;
+    bool *model;
+    SolverResult result;
+} ZbddJob;
+
+// Function run by the ZBDD thread
+DWORD WINAPI zbdd_worker(void *param) {
+    ZbddJob *job = param;
+    trace_thread_name("zbdd resolution");
+    job->result = zbdd_eliminate(job->formula, job->budget, job->stats, job->model);
+    return 0;
+}
+
+// Function to decide a formula with ZBDD resolution
+// The operations recurse once per literal on a path, deeper than the default 1 MB stack allows
+static SolverResult zbdd_resolution(Formula *formula, Budget *budget, SolverStats *stats, bool *model) {
+    ZbddJob job = {formula, budget, stats, model, RESULT_UNKNOWN};
+    HANDLE thread = CreateThread(NULL, ZBDD_STACK_SIZE, zbdd_worker, &job, STACK_SIZE_PARAM_IS_A_RESERVATION, NULL);
+    if (!thread) {
+        stats->stop_reason = STOP_OUT_OF_MEMORY;
+        return RESULT_UNKNOWN;
+    }
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+    return job.result;
+}
+
+/*
+ * External-memory saturation
+ *
+ * With a spill directory, the given-clause loop keeps only its active clauses in
+ * memory, as sorted literal codes. Every resolvent goes to the passive set. That
+ * set is a buffer which, once full, is sorted and written to disk as a run of
+ * varint-compressed clauses, each coded as deltas between its sorted literals.
+ * Passive clauses are ordered shortest first, then lexicographically. The next
+ * given clause is therefore the smallest head among the buffer and the runs, and
+ * all copies of one clause come up together, so the same sort-merge drops them.
+ * When the runs grow too many they are merged into one. A hash table over the
+ * active clauses rejects resolvents that were already selected. Memory then
+ * grows with the active set only; the passive set, usually far larger, costs
+ * disk space.
+ */
+
+#define SPILL_BUFFER_CODES (1 << 22)  // Literal codes buffered before a run is written (16 MB)
+#define SPILL_MAX_RUNS 32             // Runs merged into one once there are more
+#define SPILL_IO_BUFFER (1 << 16)
+
+// One sorted run of passive clauses on disk, read back one clause at a time
+typedef struct {
+    FILE *file;
+    char path[MAX_PATH];
+    int *head;           // Codes of the smallest clause not yet taken
+    int head_length;     // -1 once the run is exhausted
+    int head_capacity;
+} SpillRun;
+
+typedef struct {
+    int num_variables;
+    const char *dir;
+    long id;             // Distinguishes concurrent runs of one process
+    int next_run;
+    bool failed;         // A run could not be written or read
+    
+    // Active clauses: clause a holds active_codes[active_start[a] .. active_start[a + 1])
+    int *active_codes;
+    size_t active_size;
+    size_t active_capacity;
+    size_t *active_start;
+    int num_active;
+    int start_capacity;
+    int *table;          // Open addressing over the active clauses (slot = index + 1, 0 = empty)
+    int table_capacity;
+    
+    // Passive buffer: clauses stored as a length followed by the codes, a heap orders their offsets
+    int *buffer;
+    size_t buffer_size;
+    size_t buffer_capacity;
+    int *heap;
+    int heap_size;
+    int heap_capacity;
+    SpillRun *runs;
+    int num_runs;
+    long long passive;   // Passive clauses held, copies included
+} Spill;
+
+static volatile LONG spill_instances = 0;
+
+// Function to order two clauses given as sorted codes: shorter first, then lexicographically
+static int compare_coded(const int *a, int a_length, const int *b, int b_length) {
+    if (a_length != b_length) return a_length < b_length ? -1 : 1;
+    for (int k = 0; k < a_length; k++) {
+        if (a[k] != b[k]) return a[k] < b[k] ? -1 : 1;
+    }
+    return 0;
+}
+
+// Function to hash a clause given as sorted codes
+static uint64_t hash_coded(const int *codes, int length) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (uint64_t)length;
+    for (int k = 0; k < length; k++) h = (h ^ (uint64_t)(unsigned)codes[k]) * 0x100000001B3ULL;
+    return h ^ (h >> 29);
+}
+
+// Function to find the table slot of an active clause, or the empty slot where it would go
+static int spill_active_slot(Spill *s, const int *codes, int length) {
+    int mask = s->table_capacity - 1;
+    int slot = (int)(hash_coded(codes, length) & (uint64_t)mask);
+    while (s->table[slot] != 0) {
+        int a = s->table[slot] - 1;
+        size_t from = s->active_start[a];
+        if (compare_coded(s->active_codes + from, (int)(s->active_start[a + 1] - from), codes, length) == 0) break;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Function to add a clause to the active set
+static bool spill_activate(Spill *s, const int *codes, int length) {
+    if (s->active_size + length > s->active_capacity) {
+        size_t new_capacity = s->active_capacity * GROWTH_FACTOR + length;
+        int *grown = realloc(s->active_codes, new_capacity * sizeof(int));
+        if (!grown) return false;
+        s->active_codes = grown;
+        s->active_capacity = new_capacity;
+    }
+    if (s->num_active + 2 > s->start_capacity) {
+        int new_capacity = s->start_capacity * GROWTH_FACTOR;
+        size_t *grown = realloc(s->active_start, new_capacity * sizeof(size_t));
+        if (!grown) return false;
+        s->active_start = grown;
+        s->start_capacity = new_capacity;
+    }
+    if (2 * (s->num_active + 1) > s->table_capacity) {
+        int new_capacity = s->table_capacity * 2;
+        int *table = calloc(new_capacity, sizeof(int));
+        if (!table) return false;
+        free(s->table);
+        s->table = table;
+        s->table_capacity = new_capacity;
+        for (int a = 0; a < s->num_active; a++) {
+            size_t from = s->active_start[a];
+            s->table[spill_active_slot(s, s->active_codes + from, (int)(s->active_start[a + 1] - from))] = a + 1;
+        }
+    }
+    memcpy(s->active_codes + s->active_size, codes, length * sizeof(int));
+    s->active_size += length;
+    s->table[spill_active_slot(s, codes, length)] = ++s->num_active;
+    s->active_start[s->num_active] = s->active_size;
+    return true;
+}
+
+// Function to check whether a clause is active already
+static bool spill_is_active(Spill *s, const int *codes, int length) {
+    return s->table[spill_active_slot(s, codes, length)] != 0;
+}
+
+// Function to order two buffered clauses by their offsets
+static bool spill_buffer_before(Spill *s, int a, int b) {
+    return compare_coded(s->buffer + a + 1, s->buffer[a], s->buffer + b + 1, s->buffer[b]) < 0;
+}
+
+// Function to take the smallest buffered clause off the heap, returns its offset
+static int spill_pop_buffer(Spill *s) {
+    int top = s->heap[0];
+    int last = s->heap[--s->heap_size];
+    int pos = 0;
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= s->heap_size) break;
+        if (child + 1 < s->heap_size && spill_buffer_before(s, s->heap[child + 1], s->heap[child])) child++;
+        if (!spill_buffer_before(s, s->heap[child], last)) break;
+        s->heap[pos] = s->heap[child];
+        pos = child;
+    }
+    if (s->heap_size > 0) s->heap[pos] = last;
+    return top;
+}
+
+// Function to write an unsigned number as a LEB128 varint, returns the bytes written
+static int spill_put_number(FILE *file, uint64_t value) {
+    int bytes = 1;
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7F) | 0x80, file);
+        value >>= 7;
+        bytes++;
+    }
+    fputc((int)value, file);
+    return bytes;
+}
+
+// Function to read a LEB128 varint, false at the end of the file
+static bool spill_get_number(FILE *file, uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(file);
+        if (c == EOF) return false;
+        *value |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+// Function to write one clause of a run: its length, its first code, then the gaps between codes
+static long long spill_put_clause(FILE *file, const int *codes, int length) {
+    long long bytes = spill_put_number(file, (uint64_t)length);
+    for (int k = 0; k < length; k++) bytes += spill_put_number(file, (uint64_t)(codes[k] - (k > 0 ? codes[k - 1] : 0)));
+    return bytes;
+}
+
+// Function to read the next clause of a run into its head, marking the run exhausted at its end
+static bool spill_advance(SpillRun *run) {
+    uint64_t length, gap;
+    run->head_length = -1;
+    if (!spill_get_number(run->file, &length)) return !ferror(run->file);
+    if (length > (uint64_t)run->head_capacity) {
+        int *grown = realloc(run->head, length * sizeof(int));
+        if (!grown) return false;
+        run->head = grown;
+        run->head_capacity = (int)length;
+    }
+    for (int k = 0; k < (int)length; k++) {
+        if (!spill_get_number(run->file, &gap)) return false;
+        run->head[k] = (int)gap + (k > 0 ? run->head[k - 1] : 0);
+    }
+    run->head_length = (int)length;
+    return true;
+}
+
+// Function to open a new run file for writing
+static FILE *spill_create(Spill *s, char *path) {
+    snprintf(path, MAX_PATH, "%s/spill-%lu-%ld-%d.run", s->dir, (unsigned long)GetCurrentProcessId(), s->id,
+             s->next_run++);
+    FILE *file = fopen(path, "wb");
+    if (file) setvbuf(file, NULL, _IOFBF, SPILL_IO_BUFFER);
+    return file;
+}
+
+// Function to reopen a finished run for reading and load its first clause
+static bool spill_open_run(Spill *s, const char *path) {
+    SpillRun *runs = realloc(s->runs, (s->num_runs + 1) * sizeof(SpillRun));
+    if (!runs) return false;
+    s->runs = runs;
+    SpillRun *run = &s->runs[s->num_runs];
+    memset(run, 0, sizeof(*run));
+    strncpy(run->path, path, MAX_PATH - 1);
+    run->file = fopen(path, "rb");
+    if (!run->file) return false;
+    setvbuf(run->file, NULL, _IOFBF, SPILL_IO_BUFFER);
+    s->num_runs++;
+    return spill_advance(run);
+}
+
+// Function to close a run and delete its file
+static void spill_close_run(SpillRun *run) {
+    if (run->file) fclose(run->file);
+    remove(run->path);
+    free(run->head);
+}
+
+// Function to find the run with the smallest head, -1 when all are exhausted
+static int spill_smallest_run(Spill *s) {
+    int best = -1;
+    for (int r = 0; r < s->num_runs; r++) {
+        SpillRun *run = &s->runs[r];
+        if (run->head_length < 0) continue;
+        if (best < 0 || compare_coded(run->head, run->head_length, s->runs[best].head, s->runs[best].head_length) < 0) {
+            best = r;
+        }
+    }
+    return best;
+}
+
+// Function to merge every run into one, dropping copies; the old runs are deleted
+static bool spill_merge_runs(Spill *s, SolverStats *stats) {
+    char path[MAX_PATH];
+    FILE *file = spill_create(s, path);
+    if (!file) return false;
+    int *last = NULL, last_length = -1, last_capacity = 0;
+    bool ok = true;
+    for (int r = spill_smallest_run(s); r >= 0 && ok; r = spill_smallest_run(s)) {
+        SpillRun *run = &s->runs[r];
+        if (compare_coded(run->head, run->head_length, last, last_length) == 0) {
+            stats->duplicates++;
+            s->passive--;
+        } else {
+            spill_put_clause(file, run->head, run->head_length);
+            if (run->head_length > last_capacity) {
+                int *grown = realloc(last, run->head_length * sizeof(int));
+                ok = grown != NULL;
+                if (!ok) break;
+                last = grown;
+                last_capacity = run->head_length;
+            }
+            memcpy(last, run->head, run->head_length * sizeof(int));
+            last_length = run->head_length;
+        }
+        ok = spill_advance(run);
+    }
+    free(last);
+    if (ferror(file)) ok = false;
+    if (fclose(file) != 0) ok = false;
+    for (int r = 0; r < s->num_runs; r++) spill_close_run(&s->runs[r]);
+    s->num_runs = 0;
+    if (!ok) {
+        remove(path);
+        return false;
+    }
+    return spill_open_run(s, path);
+}
+
+// Function to write the buffered clauses to disk as a sorted run without copies
+static bool spill_flush(Spill *s, SolverStats *stats) {
+    char path[MAX_PATH];
+    FILE *file = spill_create(s, path);
+    if (!file) return false;
+    int previous = -1;
+    long long bytes = 0;
+    while (s->heap_size > 0) {
+        int offset = spill_pop_buffer(s);
+        if (previous >= 0 && compare_coded(s->buffer + offset + 1, s->buffer[offset], s->buffer + previous + 1,
+                                           s->buffer[previous]) == 0) {
+            stats->duplicates++;
+            s->passive--;
+            continue;
+        }
+        bytes += spill_put_clause(file, s->buffer + offset + 1, s->buffer[offset]);
+        previous = offset;
+    }
+    s->buffer_size = 0;
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    stats->spill_runs++;
+    if (!ok) {
+        remove(path);
+        return false;
+    }
+    stats->spill_bytes += bytes;
+    if (!spill_open_run(s, path)) return false;
+    return s->num_runs <= SPILL_MAX_RUNS || spill_merge_runs(s, stats);
+}
+
+// Function to add a resolvent to the passive set, writing a run first when the buffer is full
+static bool spill_push(Spill *s, const int *codes, int length, SolverStats *stats) {
+    if (s->buffer_size + length + 1 > s->buffer_capacity && s->heap_size > 0 && !spill_flush(s, stats)) {
+        s->failed = true;
+        return false;
+    }
+    if (s->buffer_size + length + 1 > s->buffer_capacity) {
+        size_t new_capacity = s->buffer_size + length + 1;
+        int *grown = realloc(s->buffer, new_capacity * sizeof(int));
+        if (!grown) return false;
+        s->buffer = grown;
+        s->buffer_capacity = new_capacity;
+    }
+    int offset = (int)s->buffer_size;
+    s->buffer[offset] = length;
+    memcpy(s->buffer + offset + 1, codes, length * sizeof(int));
+    s->buffer_size += length + 1;
+    
+    if (!push_index(&s->heap, &s->heap_size, &s->heap_capacity, offset)) return false;
+    int pos = s->heap_size - 1;
+    while (pos > 0 && spill_buffer_before(s, offset, s->heap[(pos - 1) / 2])) {
+        s->heap[pos] = s->heap[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    s->heap[pos] = offset;
+    s->passive++;
+    return true;
+}
+
+// Function to take the smallest passive clause into given and drop its copies, false when none is left
+static bool spill_pop(Spill *s, int **given, int *given_capacity, int *given_length, SolverStats *stats) {
+    int r = spill_smallest_run(s);
+    const int *codes = NULL;
+    int length = -1;
+    if (s->heap_size > 0) {
+        codes = s->buffer + s->heap[0] + 1;
+        length = s->buffer[s->heap[0]];
+    }
+    if (r >= 0 && (length < 0 || compare_coded(s->runs[r].head, s->runs[r].head_length, codes, length) < 0)) {
+        codes = s->runs[r].head;
+        length = s->runs[r].head_length;
+    }
+    if (length < 0) return false;
+    if (length > *given_capacity) {
+        int *grown = realloc(*given, length * sizeof(int));
+        if (!grown) return false;
+        *given = grown;
+        *given_capacity = length;
+    }
+    memcpy(*given, codes, length * sizeof(int));
+    *given_length = length;
+    
+    // Copies sit at the front of the buffer and of every run
+    long long copies = 0;
+    while (s->heap_size > 0 &&
+           compare_coded(s->buffer + s->heap[0] + 1, s->buffer[s->heap[0]], *given, length) == 0) {
+        spill_pop_buffer(s);
+        copies++;
+    }
+    if (s->heap_size == 0) s->buffer_size = 0;
+    for (r = 0; r < s->num_runs && !s->failed; r++) {
+        SpillRun *run = &s->runs[r];
+        while (run->head_length >= 0 && compare_coded(run->head, run->head_length, *given, length) == 0) {
+            copies++;
+            if (!spill_advance(run)) {
+                s->failed = true;
+                break;
+            }
+        }
+    }
+    s->passive -= copies;
+    stats->duplicates += copies - 1;
+    return !s->failed;
+}
+
+// Function to resolve two clauses of sorted codes on every clashing literal
+// Resolvents go to the passive set; returns true when the empty clause is derived
+static bool spill_resolve(Spill *s, const int *a, int a_length, const int *b, int b_length, int *resolvent,
+                          Budget *budget, SolverStats *stats) {
+    for (int k = 0; k < a_length; k++) {
+        int low = 0, high = b_length - 1, j = -1;
+        while (low <= high) {
+            int mid = (low + high) / 2;
+            if (b[mid] == (a[k] ^ 1)) {
+                j = mid;
+                break;
+            }
+            if (b[mid] < (a[k] ^ 1)) low = mid + 1;
+            else high = mid - 1;
+        }
+        if (j < 0) continue;
+        stats->clashes++;
+        
+        // Merge both clauses without the clashing pair; x and !x would be adjacent codes
+        int length = 0, i = 0, m = 0;
+        bool tautology = false;
+        while (i < a_length || m < b_length) {
+            if (i == k) {
+                i++;
+                continue;
+            }
+            if (m == j) {
+                m++;
+                continue;
+            }
+            int code;
+            if (m >= b_length || (i < a_length && a[i] <= b[m])) {
+                code = a[i++];
+                if (m < b_length && b[m] == code) m++;
+            } else {
+                code = b[m++];
+            }
+            if (length > 0 && resolvent[length - 1] == (code ^ 1) && (code & 1)) tautology = true;
+            resolvent[length++] = code;
+        }
+        if (tautology) {
+            stats->tautologies++;
+            continue;
+        }
+        if (length == 0) return true;
+        if (spill_is_active(s, resolvent, length)) {
+            stats->duplicates++;
+            continue;
+        }
+        if (!spill_push(s, resolvent, length, stats)) {
+            stats->stop_reason = s->failed ? STOP_SPILL_FAILED : STOP_OUT_OF_MEMORY;
+            return false;
+        }
+        stats->kept++;
+        if (budget->max_clauses > 0 && s->num_active + s->passive > budget->max_clauses) {
+            stats->stop_reason = STOP_CLAUSE_LIMIT;
+            return false;
+        }
+    }
+    return false;
+}
+
+// Function to record the size of the clause set and the memory it holds
+static void spill_update_stats(Spill *s, SolverStats *stats) {
+    long long held = s->num_active + s->passive;
+    stats->clauses = held > INT_MAX ? INT_MAX : (int)held;
+    if (stats->clauses > stats->max_clauses) stats->max_clauses = stats->clauses;
+    stats->memory = s->active_capacity * sizeof(int) + (size_t)s->start_capacity * sizeof(size_t) +
+                    (size_t)s->table_capacity * sizeof(int) + s->buffer_capacity * sizeof(int) +
+                    (size_t)s->heap_capacity * sizeof(int);
+}
+
+// Function to saturate with the given-clause loop, keeping the passive clauses in runs on disk
+// The smallest passive clause is given next, so unit clauses come first as with STRATEGY_UNIT
+static SolverResult spill_resolution(Formula *formula, SearchOptions *search, Budget *budget, SolverStats *stats,
+                                     bool *model) {
+    double phase_start = now_seconds();
+    Spill s;
+    memset(&s, 0, sizeof(s));
+    s.num_variables = formula->num_variables;
+    s.dir = search->spill_dir;
+    s.id = (long)InterlockedIncrement(&spill_instances);
+    s.active_capacity = INITIAL_CAPACITY;
+    s.start_capacity = INITIAL_CAPACITY;
+    s.table_capacity = 256;
+    s.buffer_capacity = SPILL_BUFFER_CODES;
+    if (budget->max_memory > 0 && budget->max_memory / 4 / sizeof(int) < s.buffer_capacity) {
+        // The buffer takes at most a quarter of the memory budget, the active set needs the rest
+        s.buffer_capacity = budget->max_memory / 4 / sizeof(int);
+        if (s.buffer_capacity < INITIAL_CAPACITY) s.buffer_capacity = INITIAL_CAPACITY;
+    }
+    s.heap_capacity = INITIAL_CAPACITY;
+    s.active_codes = malloc(s.active_capacity * sizeof(int));
+    s.active_start = malloc(s.start_capacity * sizeof(size_t));
+    s.table = calloc(s.table_capacity, sizeof(int));
+    s.buffer = malloc(s.buffer_capacity * sizeof(int));
+    s.heap = malloc(s.heap_capacity * sizeof(int));
+    int codes_capacity = 2 * formula->num_variables + 1;  // A resolvent holds each literal at most once
+    for (int c = 0; c < formula->num_clauses; c++) {
+        if (formula->clauses[c].num_literals > codes_capacity) codes_capacity = formula->clauses[c].num_literals;
+    }
+    int *codes = malloc(codes_capacity * sizeof(int));
+    int *given = NULL, given_capacity = 0, given_length = 0;
+    bool ok = s.active_codes && s.active_start && s.table && s.buffer && s.heap && codes;
+    bool found_empty = false;
+    if (ok) s.active_start[0] = 0;
+    
+    // Input clauses as sorted codes without repeats; tautologies hold in every model and are left out
+    TRACE_BEGIN("setup");
+    for (int c = 0; ok && c < formula->num_clauses && !found_empty; c++) {
+        Clause *clause = &formula->clauses[c];
+        int length = 0;
+        bool tautology = false;
+        for (int k = 0; k < clause->num_literals; k++) {
+            int code = literal_code(formula, &clause->literals[k]), j = length;
+            for (; j > 0 && codes[j - 1] > code; j--) codes[j] = codes[j - 1];
+            codes[j] = code;
+            length++;
+        }
+        int distinct = 0;
+        for (int k = 0; k < length; k++) {
+            if (distinct > 0 && codes[distinct - 1] == codes[k]) continue;
+            if (distinct > 0 && codes[distinct - 1] == (codes[k] ^ 1) && (codes[k] & 1)) tautology = true;
+            codes[distinct++] = codes[k];
+        }
+        if (tautology) continue;
+        if (distinct == 0) {
+            found_empty = true;
+        } else if (search->strategy == STRATEGY_SOS && !in_goal(formula, search, c)) {
+            if (!spill_is_active(&s, codes, distinct)) ok = spill_activate(&s, codes, distinct);
+        } else {
+            ok = spill_push(&s, codes, distinct, stats);
+        }
+    }
+    if (!ok) stats->stop_reason = s.failed ? STOP_SPILL_FAILED : STOP_OUT_OF_MEMORY;
+    double saturation_start = now_seconds();
+    stats->setup_time = saturation_start - phase_start;
+    TRACE_END("setup");
+    
+    TRACE_BEGIN("saturation");
+    while (!found_empty && stats->stop_reason == STOP_NONE) {
+        if (!spill_pop(&s, &given, &given_capacity, &given_length, stats)) {
+            if (s.failed) stats->stop_reason = STOP_SPILL_FAILED;
+            break;
+        }
+        if (spill_is_active(&s, given, given_length)) {
+            stats->duplicates++;
+            continue;
+        }
+        stats->given++;
+        TRACE_BEGIN_ARG("given", given_length);
+        for (int a = 0; a < s.num_active && !found_empty && stats->stop_reason == STOP_NONE; a++) {
+            if (++stats->pairs_tried % BUDGET_CHECK_INTERVAL == 0) {
+                stats->saturation_time = now_seconds() - saturation_start;
+                spill_update_stats(&s, stats);
+                TRACE_COUNTER("clauses", stats->clauses);
+                if (budget_exhausted(budget, stats)) break;
+            }
+            size_t from = s.active_start[a];
+            found_empty = spill_resolve(&s, s.active_codes + from, (int)(s.active_start[a + 1] - from), given,
+                                        given_length, codes, budget, stats);
+        }
+        if (!found_empty && stats->stop_reason == STOP_NONE && !spill_activate(&s, given, given_length)) {
+            stats->stop_reason = STOP_OUT_OF_MEMORY;
+        }
+        TRACE_END("given");
+    }
+    spill_update_stats(&s, stats);
+    stats->saturation_time = now_seconds() - saturation_start;
+    TRACE_END("saturation");
+    
+    // As in memory, a saturated set of support proves nothing when the goal was chosen by hand
+    if (!found_empty && stats->stop_reason == STOP_NONE && search->strategy == STRATEGY_SOS &&
+        search->goal_clauses > 0) {
+        stats->stop_reason = STOP_INCOMPLETE;
+    }
+    if (!found_empty && model && stats->stop_reason == STOP_NONE) {
+        TRACE_BEGIN("model");
+        bool prefer_true = search->strategy == STRATEGY_SOS;
+        int *clause_start = s.active_size <= INT_MAX ? malloc(((size_t)s.num_active + 1) * sizeof(int)) : NULL;
+        for (int a = 0; clause_start && a <= s.num_active; a++) clause_start[a] = (int)s.active_start[a];
+        if (!clause_start || !decide_model(formula->num_variables, clause_start, s.active_codes, s.num_active,
+                                           prefer_true, model)) {
+            stats->stop_reason = STOP_OUT_OF_MEMORY;
+        } else if (search->strategy == STRATEGY_SOS && !verify_model(formula, model)) {
+            stats->stop_reason = STOP_INCOMPLETE;
+        }
+        free(clause_start);
+        TRACE_END("model");
+    }
+    
+    for (int r = 0; r < s.num_runs; r++) spill_close_run(&s.runs[r]);
+    free(s.runs);
+    free(s.active_codes);
+    free(s.active_start);
+    free(s.table);
+    free(s.buffer);
+    free(s.heap);
+    free(codes);
+    free(given);
+    
+    if (found_empty) return RESULT_UNSATISFIABLE;
+    return stats->stop_reason == STOP_NONE ? RESULT_SATISFIABLE : RESULT_UNKNOWN;
+}
+
+/*
+ * Local search
+ *
+ * --strategy sls looks for a model instead of saturating: a satisfiable formula
+ * with many clauses would otherwise need its whole saturation to be derived
+ * before the model is read off. Starting from a random assignment, probSAT
+ * repeatedly picks a falsified clause at random and flips one of its variables,
+ * chosen with a probability that falls with its break count (the clauses the
+ * flip would falsify). Each clause keeps its number of true literals and the
+ * XOR of their variables, which is the only true variable once the count drops
+ * to one, so a flip updates the falsified-clause list and the break counts by
+ * visiting the occurrences of the two literals of the flipped variable.
+ *
+ * Several threads search independently from different seeds, each restarting
+ * from a fresh random assignment every so many flips, until one satisfies every
+ * clause or the flip budget shared by all of them runs out. The search never
+ * shows a formula unsatisfiable, so it answers SATISFIABLE or UNKNOWN, apart
+ * from the refutations seen while setting up: an empty clause or two
+ * complementary unit clauses, which is how --preprocess writes a refuted formula.
+ */
+
+#define LS_DEFAULT_FLIPS 100000000LL  // Flips over all threads when --flips is not given
+#define LS_RESTART_FLIPS 10000        // Flips per variable before a thread restarts, at least 100000
+#define LS_MAX_BREAK 64               // Break counts with their own weight, larger ones share the last
+#define LS_MAX_THREADS 64
+
+// Clauses and settings shared by the search threads
+typedef struct {
+    int num_variables;
+    int num_clauses;
+    int *clause_start;     // Clause c holds the distinct codes codes[clause_start[c] .. clause_start[c + 1])
+    int *codes;
+    int *occurs_start;     // Clauses holding literal code l: occurs[occurs_start[l] .. occurs_start[l + 1])
+    int *occurs;
+    double weight[LS_MAX_BREAK + 1];  // probSAT weight of a variable by its break count
+    long long max_flips;
+    long long restart_flips;
+    uint64_t seed;
+    Budget *budget;
+    volatile LONG64 flips;     // Flips made by all threads, added up as each claims its next chunk
+    volatile LONG64 claimed;   // Flips handed out to the threads, in chunks of at most BUDGET_CHECK_INTERVAL
+    volatile LONG64 restarts;
+    volatile LONG found;       // Set by the thread that satisfied every clause, stops the others
+    bool *model;
+    StopReason stop_reason;    // Why the first thread to give up stopped
+    volatile LONG stopped;
+} LocalSearch;
+
+// Assignment and caches of one search thread
+typedef struct {
+    LocalSearch *ls;
+    int id;
+    bool *value;
+    int *true_count;       // True literals of each clause
+    int *true_vars;        // XOR of the variables of those literals
+    int *break_count;      // Clauses each variable is the only true literal of
+    int *unsat;            // Falsified clauses
+    int *unsat_position;   // Position of each clause in unsat, -1 when satisfied
+    int num_unsat;
+    uint64_t random;
+} LocalSearcher;
+
+// Function to draw the next number of a thread's xorshift64* generator
+static uint64_t ls_next_random(LocalSearcher *s) {
+    s->random ^= s->random >> 12;
+    s->random ^= s->random << 25;
+    s->random ^= s->random >> 27;
+    return s->random * 0x2545F4914F6CDD1DULL;
+}
+
+// Function to take a clause off the falsified list
+static void ls_satisfy(LocalSearcher *s, int c) {
+    int position = s->unsat_position[c];
+    int last = s->unsat[--s->num_unsat];
+    s->unsat[position] = last;
+    s->unsat_position[last] = position;
+    s->unsat_position[c] = -1;
+}
+
+// Function to put a clause on the falsified list
+static void ls_falsify(LocalSearcher *s, int c) {
+    s->unsat_position[c] = s->num_unsat;
+    s->unsat[s->num_unsat++] = c;
+}
+
+// Function to start a thread over from a random assignment and rebuild its caches
+static void ls_restart(LocalSearcher *s) {
+    LocalSearch *ls = s->ls;
+    for (int v = 0; v < ls->num_variables; v++) s->value[v] = ls_next_random(s) >> 63;
+    memset(s->break_count, 0, ls->num_variables * sizeof(int));
+    s->num_unsat = 0;
+    for (int c = 0; c < ls->num_clauses; c++) {
+        int count = 0, vars = 0;
+        for (int k = ls->clause_start[c]; k < ls->clause_start[c + 1]; k++) {
+            int code = ls->codes[k];
+            if (s->value[code >> 1] != (code & 1)) {
+                count++;
+                vars ^= code >> 1;
+            }
+        }
+        s->true_count[c] = count;
+        s->true_vars[c] = vars;
+        s->unsat_position[c] = -1;
+        if (count == 0) ls_falsify(s, c);
+        if (count == 1) s->break_count[vars]++;
+    }
+}
+
+// Function to flip a variable and update the clauses holding either of its literals
+static void ls_flip(LocalSearcher *s, int var) {
+    LocalSearch *ls = s->ls;
+    s->value[var] = !s->value[var];
+    int made = 2 * var + (s->value[var] ? 0 : 1);  // The literal of var that just became true
+    for (int o = ls->occurs_start[made]; o < ls->occurs_start[made + 1]; o++) {
+        int c = ls->occurs[o];
+        if (s->true_count[c] == 0) {
+            ls_satisfy(s, c);
+            s->break_count[var]++;
+        } else if (s->true_count[c] == 1) {
+            s->break_count[s->true_vars[c]]--;
+        }
+        s->true_count[c]++;
+        s->true_vars[c] ^= var;
+    }
+    for (int o = ls->occurs_start[made ^ 1]; o < ls->occurs_start[(made ^ 1) + 1]; o++) {
+        int c = ls->occurs[o];
+        s->true_count[c]--;
+        s->true_vars[c] ^= var;
+        if (s->true_count[c] == 0) {
+            ls_falsify(s, c);
+            s->break_count[var]--;
+        } else if (s->true_count[c] == 1) {
+            s->break_count[s->true_vars[c]]++;
+        }
+    }
+}
+
+// Function to look up the probSAT weight of a variable of a thread
+static double ls_weight(LocalSearcher *s, int var) {
+    int breaks = s->break_count[var];
+    return s->ls->weight[breaks < LS_MAX_BREAK ? breaks : LS_MAX_BREAK];
+}
+
+// Function to pick the variable to flip in a falsified clause, with probability proportional to its weight
+static int ls_pick(LocalSearcher *s, int c) {
+    LocalSearch *ls = s->ls;
+    int first = ls->clause_start[c], last = ls->clause_start[c + 1] - 1;
+    double sum = 0;
+    for (int k = first; k <= last; k++) sum += ls_weight(s, ls->codes[k] >> 1);
+    double target = (double)(ls_next_random(s) >> 11) * (1.0 / 9007199254740992.0) * sum;  // Uniform in [0, sum)
+    for (int k = first; k < last; k++) {
+        target -= ls_weight(s, ls->codes[k] >> 1);
+        if (target < 0) return ls->codes[k] >> 1;
+    }
+    return ls->codes[last] >> 1;
+}
+
+// Function to record why a thread gave up, unless another thread stopped first
+static void ls_stop(LocalSearch *ls, StopReason reason) {
+    if (InterlockedCompareExchange(&ls->stopped, 1, 0) == 0) ls->stop_reason = reason;
+}
+
+// Function run by each search thread: flips until a model is found or the budget runs out
+DWORD WINAPI ls_worker(void *param) {
+    LocalSearcher *s = param;
+    LocalSearch *ls = s->ls;
+    trace_thread_name("local search");
+    SolverStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.variables = ls->num_variables;
+    stats.clauses = ls->num_clauses;
+    Budget budget = *ls->budget;
+    if (s->id > 0) budget.progress_interval = 0;  // One thread reports progress
+    
+    ls_restart(s);
+    long long flips = 0, allowed = 0, counted = 0, since_restart = 0;
+    while (!ls->found) {
+        if (s->num_unsat == 0) {
+            if (InterlockedCompareExchange(&ls->found, 1, 0) == 0) {
+                memcpy(ls->model, s->value, ls->num_variables * sizeof(bool));
+            }
+            break;
+        }
+        
+        // Flips are claimed from the shared budget before they are made, so no thread goes past it
+        if (flips == allowed) {
+            stats.flips = InterlockedExchangeAdd64(&ls->flips, flips - counted) + flips - counted;
+            stats.restarts = ls->restarts;
+            counted = flips;
+            if (flips > 0 && budget_exhausted(&budget, &stats)) {
+                ls_stop(ls, stats.stop_reason);
+                break;
+            }
+            long long left = ls->max_flips - InterlockedExchangeAdd64(&ls->claimed, BUDGET_CHECK_INTERVAL);
+            if (left <= 0) {
+                ls_stop(ls, STOP_FLIP_LIMIT);
+                break;
+            }
+            allowed += left < BUDGET_CHECK_INTERVAL ? left : BUDGET_CHECK_INTERVAL;
+        }
+        if (++since_restart > ls->restart_flips) {
+            ls_restart(s);
+            InterlockedIncrement64(&ls->restarts);
+            since_restart = 0;
+            continue;
+        }
+        ls_flip(s, ls_pick(s, s->unsat[ls_next_random(s) % (uint64_t)s->num_unsat]));
+        flips++;
+    }
+    InterlockedExchangeAdd64(&ls->flips, flips - counted);
+    return 0;
+}
+
+// Function to set the probSAT weights for the longest clause of the formula
+// Polynomial break for 3-SAT and below, exponential above, with the constants of Balint and Schoening
+static void ls_set_weights(LocalSearch *ls, int max_length) {
+    static const double exponential_base[] = {3.0, 3.7, 5.1, 5.4};  // Clauses of 4, 5, 6 and 7+ literals
+    for (int b = 0; b <= LS_MAX_BREAK; b++) {
+        if (max_length <= 3) {
+            ls->weight[b] = pow(0.9 + b, -2.06);
+        } else {
+            ls->weight[b] = pow(exponential_base[max_length < 7 ? max_length - 4 : 3], -(double)b);
+        }
+    }
+}
+
+// Function to search for a model by probSAT on several threads
+// Returns SATISFIABLE with the model, UNSATISFIABLE only for an empty input clause, UNKNOWN otherwise
+static SolverResult local_search(Formula *formula, SearchOptions *search, Budget *budget, SolverStats *stats,
+                                 bool *model) {
+    double phase_start = now_seconds();
+    LocalSearch ls;
+    memset(&ls, 0, sizeof(ls));
+    ls.num_variables = formula->num_variables;
+    ls.budget = budget;
+    ls.max_flips = search->max_flips > 0 ? search->max_flips : LS_DEFAULT_FLIPS;
+    ls.restart_flips = (long long)LS_RESTART_FLIPS * formula->num_variables;
+    if (ls.restart_flips < 100000) ls.restart_flips = 100000;
+    ls.seed = search->seed;
+    ls.model = model;
+    
+    int total = 0;
+    for (int c = 0; c < formula->num_clauses; c++) total += formula->clauses[c].num_literals;
+    int num_codes = 2 * formula->num_variables;
+    ls.clause_start = malloc((formula->num_clauses + 1) * sizeof(int));
+    ls.codes = malloc((total + 1) * sizeof(int));
+    ls.occurs_start = calloc(num_codes + 2, sizeof(int));
+    ls.occurs = malloc((total + 1) * sizeof(int));
+    bool ok = ls.clause_start && ls.codes && ls.occurs_start && ls.occurs;
+    bool refuted = false;  // An empty clause or two complementary unit clauses
+    
+    // Clauses as distinct codes; tautologies hold under every assignment and are left out
+    TRACE_BEGIN("setup");
+    int max_length = 0, size = 0;
+    if (ok) ls.clause_start[0] = 0;
+    for (int c = 0; ok && c < formula->num_clauses && !refuted; c++) {
+        Clause *clause = &formula->clauses[c];
+        int *codes = ls.codes + size, length = 0;
+        bool tautology = false;
+        for (int k = 0; k < clause->num_literals; k++) {
+            int code = literal_code(formula, &clause->literals[k]), j = length;
+            for (; j > 0 && codes[j - 1] > code; j--) codes[j] = codes[j - 1];
+            codes[j] = code;
+            length++;
+        }
+        int distinct = 0;
+        for (int k = 0; k < length; k++) {
+            if (distinct > 0 && codes[distinct - 1] == codes[k]) continue;
+            if (distinct > 0 && codes[distinct - 1] == (codes[k] ^ 1) && (codes[k] & 1)) tautology = true;
+            codes[distinct++] = codes[k];
+        }
+        if (tautology) continue;
+        refuted = distinct == 0;
+        if (distinct > max_length) max_length = distinct;
+        size += distinct;
+        ls.clause_start[++ls.num_clauses] = size;
+    }
+    char *unit = ok && !refuted ? calloc(num_codes + 1, 1) : NULL;
+    ok = ok && (refuted || unit);
+    for (int c = 0; unit && c < ls.num_clauses && !refuted; c++) {
+        if (ls.clause_start[c + 1] - ls.clause_start[c] != 1) continue;
+        int code = ls.codes[ls.clause_start[c]];
+        refuted = unit[code ^ 1];
+        unit[code] = 1;
+    }
+    free(unit);
+    for (int k = 0; ok && k < size; k++) ls.occurs_start[ls.codes[k] + 1]++;
+    for (int code = 0; ok && code < num_codes; code++) ls.occurs_start[code + 1] += ls.occurs_start[code];
+    int *fill = ok ? malloc((num_codes + 1) * sizeof(int)) : NULL;
+    ok = ok && fill;
+    if (ok) memcpy(fill, ls.occurs_start, num_codes * sizeof(int));
+    for (int c = 0; ok && c < ls.num_clauses; c++) {
+        for (int k = ls.clause_start[c]; k < ls.clause_start[c + 1]; k++) ls.occurs[fill[ls.codes[k]]++] = c;
+    }
+    free(fill);
+    ls_set_weights(&ls, max_length);
+    
+    int threads = search->threads;
+    if (threads <= 0) {
+        SYSTEM_INFO system_info;
+        GetSystemInfo(&system_info);
+        threads = (int)system_info.dwNumberOfProcessors;
+    }
+    if (threads > LS_MAX_THREADS) threads = LS_MAX_THREADS;
+    if (threads < 1) threads = 1;
+    LocalSearcher searchers[LS_MAX_THREADS];
+    memset(searchers, 0, sizeof(searchers));
+    size_t per_thread = (size_t)ls.num_variables * (sizeof(bool) + sizeof(int)) +
+                        (size_t)ls.num_clauses * 4 * sizeof(int);
+    for (int t = 0; ok && t < threads; t++) {
+        LocalSearcher *s = &searchers[t];
+        s->ls = &ls;
+        s->id = t;
+        s->random = (ls.seed + 1) * 0x9E3779B97F4A7C15ULL ^ ((uint64_t)t + 1) * 0xBF58476D1CE4E5B9ULL;
+        if (s->random == 0) s->random = 1;  // The one state xorshift never leaves
+        s->value = malloc((ls.num_variables + 1) * sizeof(bool));
+        s->break_count = malloc((ls.num_variables + 1) * sizeof(int));
+        s->true_count = malloc((ls.num_clauses + 1) * sizeof(int));
+        s->true_vars = malloc((ls.num_clauses + 1) * sizeof(int));
+        s->unsat = malloc((ls.num_clauses + 1) * sizeof(int));
+        s->unsat_position = malloc((ls.num_clauses + 1) * sizeof(int));
+        ok = s->value && s->break_count && s->true_count && s->true_vars && s->unsat && s->unsat_position;
+    }
+    stats->clauses = ls.num_clauses;
+    stats->max_clauses = ls.num_clauses;
+    stats->memory = ((size_t)ls.num_clauses + 2 * (size_t)size + num_codes) * sizeof(int) + threads * per_thread;
+    if (!ok) {
+        stats->stop_reason = STOP_OUT_OF_MEMORY;
+    } else if (!refuted) {
+        budget_exhausted(budget, stats);  // The clause and memory limits are checked once, nothing grows
+    }
+    double search_start = now_seconds();
+    stats->setup_time = search_start - phase_start;
+    TRACE_END("setup");
+    
+    SolverResult result = RESULT_UNKNOWN;
+    if (refuted) {
+        result = RESULT_UNSATISFIABLE;
+    } else if (stats->stop_reason == STOP_NONE) {
+        TRACE_BEGIN("search");
+        HANDLE handles[LS_MAX_THREADS];
+        int started = 0;
+        for (int t = 1; t < threads; t++) {
+            handles[started] = CreateThread(NULL, 0, ls_worker, &searchers[t], 0, NULL);
+            if (handles[started]) started++;
+        }
+        ls_worker(&searchers[0]);  // The calling thread searches too
+        if (started > 0) WaitForMultipleObjects(started, handles, TRUE, INFINITE);
+        for (int t = 0; t < started; t++) CloseHandle(handles[t]);
+        TRACE_END("search");
+        if (ls.found) {
+            result = RESULT_SATISFIABLE;
+        } else {
+            stats->stop_reason = ls.stop_reason;
+        }
+    }
+    stats->flips = ls.flips;
+    stats->restarts = ls.restarts;
+    stats->saturation_time = now_seconds() - search_start;
+    
+    for (int t = 0; t < threads; t++) {
+        free(searchers[t].value);
+        free(searchers[t].break_count);
+        free(searchers[t].true_count);
+        free(searchers[t].true_vars);
+        free(searchers[t].unsat);
+        free(searchers[t].unsat_position);
+    }
+    free(ls.clause_start);
+    free(ls.codes);
+    free(ls.occurs_start);
+    free(ls.occurs);
+    return result;
+}
+
+// Function to perform resolution by refutation within a budget
+// When refutation is not NULL and the result is UNSATISFIABLE, the working set is moved into it
+// When model is not NULL and the result is SATISFIABLE, model[v] receives the value of variable v
+// A NULL search resolves every pair (STRATEGY_SATURATE)
+SolverResult resolution(Formula *formula, SearchOptions *search, Budget *budget, SolverStats *stats,
+                        Refutation *refutation, bool *model) {
+    SearchOptions default_search = {STRATEGY_SATURATE, 0, 0, NULL, 0, 0, 0};
+    if (!search) search = &default_search;
+    double phase_start = now_seconds();
+    stats->variables = formula->num_variables;
+    stats->input_clauses = formula->num_clauses;
+    if (search->strategy == STRATEGY_ZRES) return zbdd_resolution(formula, budget, stats, model);
+    if (search->strategy == STRATEGY_SLS) return local_search(formula, search, budget, stats, model);
+    if (search->spill_dir) return spill_resolution(formula, search, budget, stats, model);
+    
+    // Create a working set of clauses
+    Clause *work_clauses = malloc(INITIAL_CAPACITY * sizeof(Clause));
+    int work_capacity = INITIAL_CAPACITY;
+    int work_size = 0;
+    
+    if (!work_clauses) {
+        stats->stop_reason = STOP_OUT_OF_MEMORY;
+        return RESULT_UNKNOWN;
+    }
+    stats->memory = work_capacity * sizeof(Clause);
+    
+    // Copy original clauses to working set, or the whole working set of the snapshot being resumed
+    TRACE_BEGIN("setup");
+    Snapshot *snapshot = resume_snapshot;
+    resume_snapshot = NULL;  // Only the first saturation of the run continues from it
+    int num_setup = snapshot ? snapshot->header->num_clauses : formula->num_clauses;
+    for (int i = 0; i < num_setup && stats->stop_reason == STOP_NONE; i++) {
+        Clause copy;
+        if (snapshot ? !snapshot_clause(snapshot, formula, i, &copy) : !copy_clause(&copy, &formula->clauses[i])) {
+            stats->stop_reason = STOP_OUT_OF_MEMORY;
+        } else if (!push_work_clause(&work_clauses, &work_size, &work_capacity, &copy, stats)) {
+            free_clause(&copy);
+            stats->stop_reason = STOP_OUT_OF_MEMORY;
+        }
+    }
+    
+    // Stored lemmas follow the input clauses, so every clause after them is a resolvent of this run
+    if (lemma_store && stats->stop_reason == STOP_NONE &&
+        !lemma_import(lemma_store, &work_clauses, &work_size, &work_capacity, stats)) {
+        stats->stop_reason = STOP_OUT_OF_MEMORY;
+    }
+    
+    SaturationCursor resumed;
+    SaturationCursor *resume = NULL;
+    if (snapshot && stats->stop_reason == STOP_NONE) {
+        snapshot_restore(snapshot, &resumed, stats);
+        resume = &resumed;
+    }
+    
+    // Perform resolution
+    bool found_empty = false;
+    int empty_parents[2] = {0, 0};
+    Formula *ordering = search->strategy == STRATEGY_ORDERED ? formula : NULL;
+    double saturation_start = now_seconds();
+    stats->setup_time = saturation_start - phase_start;
+    if (resume) saturation_start -= stats->saturation_time;  // The clock continues from the snapshot
+    TRACE_END("setup");
+    TRACE_BEGIN("saturation");
+    
+    // A width bound is raised one literal at a time, so short refutations are found cheaply first
+    int width = resume ? resume->width : search->max_width > 0 ? 1 : 0;
+    for (;;) {
+        long long too_wide_before = resume ? resume->pass_too_wide : stats->too_wide;
+        TRACE_BEGIN_ARG("width", width);
+        if (search->strategy == STRATEGY_UNIT || search->strategy == STRATEGY_SOS) {
+            found_empty = given_clause_saturation(formula, search, width, &work_clauses, &work_size,
+                                                  &work_capacity, budget, stats, saturation_start, empty_parents,
+                                                  resume);
+        } else {
+            found_empty = round_saturation(ordering, width, &work_clauses, &work_size, &work_capacity,
+                                           budget, stats, saturation_start, empty_parents, resume);
+        }
+        resume = NULL;
+        TRACE_END("width");
+        if (found_empty || stats->stop_reason != STOP_NONE || width == 0) break;
+        if (stats->too_wide == too_wide_before) break;  // Nothing was cut off: the saturation is complete
+        if (width >= search->max_width) {
+            stats->stop_reason = STOP_WIDTH_LIMIT;
+            break;
+        }
+        width++;
+    }
+    if (checkpoint_log) checkpoint_wait(checkpoint_log);  // Its writer may still read the literals
+    stats->saturation_time = now_seconds() - saturation_start;
+    TRACE_END("saturation");
+    if (lemma_store) lemma_export(lemma_store, work_clauses, work_size, stats);
+    
+    // Saturating the set of support proves satisfiability only when the rest is satisfiable,
+    // which holds for the default support (all-true satisfies every clause with a positive literal)
+    if (!found_empty && stats->stop_reason == STOP_NONE && search->strategy == STRATEGY_SOS &&
+        search->goal_clauses > 0) {
+        stats->stop_reason = STOP_INCOMPLETE;
+    }
+    
+    if (found_empty && refutation) {
+        refutation->parents[0] = empty_parents[0];
+        refutation->parents[1] = empty_parents[1];
+        refutation->clauses = work_clauses;
+        refutation->num_clauses = work_size;
+        refutation->num_inputs = formula->num_clauses;
+        refutation->used = NULL;
+        return RESULT_UNSATISFIABLE;
+    }
+    
+    // The model needs every resolvent; ordered saturation suffices because variables are decided in
+    // formula order, so both clauses falsified by a choice have that variable as their maximal one.
+    // The set of support never resolves two non-goal clauses, which all-true satisfies, so its model
+    // leans towards true and is checked; if it still falsifies a clause the answer stays UNKNOWN
+    if (!found_empty && model && stats->stop_reason == STOP_NONE) {
+        TRACE_BEGIN("model");
+        if (!build_model(formula, work_clauses, work_size, search->strategy == STRATEGY_SOS, model)) {
+            stats->stop_reason = STOP_OUT_OF_MEMORY;
+        } else if (search->strategy == STRATEGY_SOS && !verify_model(formula, model)) {
+            stats->stop_reason = STOP_INCOMPLETE;
+        }
+        TRACE_END("model");
+    }
+    
+    // Clean up
+    for (int i = 0; i < work_size; i++) {
+        free_clause(&work_clauses[i]);
+    }
+    free(work_clauses);
+    
+    if (found_empty) return RESULT_UNSATISFIABLE;
+    return stats->stop_reason == STOP_NONE ? RESULT_SATISFIABLE : RESULT_UNKNOWN;
+}
+
+// Function to free the working set held by a refutation
+void free_refutation(Refutation *refutation) {
+    for (int i = 0; i < refutation->num_clauses; i++) {
+        free_clause(&refutation->clauses[i]);
+    }
+    free(refutation->clauses);
+    free(refutation->used);
+    refutation->clauses = NULL;
+    refutation->used = NULL;
+    refutation->num_clauses = 0;
+}
+
+// Function to mark the clauses the empty clause depends on by walking the parents backwards
+bool mark_refutation(Refutation *refutation) {
+    if (refutation->used) return true;
+    refutation->used = calloc(refutation->num_clauses + 1, 1);
+    int *stack = malloc((2 * (size_t)refutation->num_clauses + 2) * sizeof(int));  // Each clause pushes its parents once
+    if (!refutation->used || !stack) {
+        free(refutation->used);
+        free(stack);
+        refutation->used = NULL;
+        return false;
+    }
+    
+    int top = 0;
+    stack[top++] = refutation->parents[0];
+    stack[top++] = refutation->parents[1];
+    while (top > 0) {
+        int index = stack[--top] - 1;
+        if (refutation->used[index]) continue;
+        refutation->used[index] = 1;
+        Clause *clause = &refutation->clauses[index];
+        if (clause->parents[0] != 0) {
+            stack[top++] = clause->parents[0];
+            stack[top++] = clause->parents[1];
+        }
+    }
+    free(stack);
+    return true;
+}
+
+// Function to copy the input clauses the refutation depends on into a new formula, in input order
+bool refutation_core(Refutation *refutation, Formula *core) {
+    if (!mark_refutation(refutation) || !init_formula(core)) return false;
+    for (int i = 0; i < refutation->num_inputs; i++) {
+        if (!refutation->used[i]) continue;
+        Clause *clause = &refutation->clauses[i];
+        bool registered = true;
+        for (int k = 0; k < clause->num_literals && registered; k++) {
+            registered = find_or_add_variable(core, clause->literals[k].var.name) >= 0;
+        }
+        if (!registered || !add_clause(core, clause)) {
+            free_formula(core);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to write only the steps the refutation depends on, numbered against the core formula
+bool write_trimmed_proof(Refutation *refutation, Formula *core, const char *filename, ProofFormat format) {
+    if (!mark_refutation(refutation)) return false;
+    int *ids = malloc((refutation->num_clauses + 1) * sizeof(int));
+    if (!ids) return false;
+    
+    // Core clauses keep their order, then the used resolvents follow in derivation order
+    int next_id = 0;
+    for (int i = 0; i < refutation->num_clauses; i++) {
+        ids[i] = refutation->used[i] ? ++next_id : 0;
+    }
+    
+    ProofWriter writer;
+    if (!proof_open(&writer, filename, format, core)) {
+        free(ids);
+        return false;
+    }
+    for (int i = refutation->num_inputs; i < refutation->num_clauses; i++) {
+        if (!refutation->used[i]) continue;
+        Clause *clause = &refutation->clauses[i];
+        proof_add(&writer, ids[i], clause, ids[clause->parents[0] - 1], ids[clause->parents[1] - 1]);
+    }
+    Clause empty = {NULL, 0, 0, {0, 0}};
+    proof_add(&writer, next_id + 1, &empty, ids[refutation->parents[0] - 1], ids[refutation->parents[1] - 1]);
+    free(ids);
+    return proof_close(&writer);
+}
+
+// Function to shrink a core by solving it again until it stops shrinking
+// On return core is the smallest core found and refutation the run that produced it
+int minimize_core(Formula *core, Refutation *refutation, SearchOptions *search, Budget *budget) {
+    // A core does not keep the goal clauses last, so the set of support falls back to the negative clauses
+    SearchOptions core_search = *search;
+    core_search.goal_clauses = 0;
+    int rounds = 0;
+    for (;;) {
+        SolverStats round_stats;
+        memset(&round_stats, 0, sizeof(round_stats));
+        budget->start_time = GetTickCount64();
+        
+        Refutation next;
+        if (resolution(core, &core_search, budget, &round_stats, &next, NULL) != RESULT_UNSATISFIABLE) break;
+        rounds++;
+        Formula smaller;
+        if (!refutation_core(&next, &smaller)) {
+            free_refutation(&next);
+            break;
+        }
+        if (smaller.num_clauses >= core->num_clauses) {
+            free_formula(&smaller);
+            free_refutation(&next);
+            break;
+        }
+        free_refutation(refutation);
+        *refutation = next;
+        free_formula(core);
+        *core = smaller;
+    }
+    return rounds;
+}
+
+/*
+ * Preprocessing
+ *
+ * Before saturation the formula is simplified on literal codes in rounds of
+ * three steps. Literals that imply each other through binary clauses form a
+ * strongly connected component of the implication graph; each component is
+ * replaced by one representative literal, so a chain x1 = x2 = ... = xn
+ * becomes a single variable. Each remaining literal is then probed: if
+ * assuming it and propagating units reaches a conflict, its negation is a
+ * unit of the formula. Along the way, a literal forced by a longer clause
+ * while probing l yields the hyper-binary resolvent (!l m). New units and
+ * binaries can create new equivalences, so the rounds repeat until nothing
+ * changes.
+ *
+ * Finally, a clause is blocked on one of its literals l when every resolvent
+ * on l is a tautology; removing it keeps the formula satisfiable. Literals
+ * are visited fewest resolution partners first, and a removal requeues the
+ * literals whose partners it was. Covered clause elimination first extends
+ * the clause with the literals shared by all its non-tautological partners,
+ * which makes more clauses blocked or tautological.
+ *
+ * Parity constraints are hard for resolution. With --xor, groups of clauses
+ * over the same k variables that rule out every assignment of one parity
+ * (2^(k-1) clauses) are read as XOR rows of a bit-packed GF(2) matrix before
+ * the rounds start. Gauss-Jordan elimination reduces the rows a word at a
+ * time: 0 = 1 refutes the formula, and short rows come back as units and
+ * binaries. A row whose pivot occurs in no clause is dropped and solved
+ * when the model is extended. The other rows are encoded as clauses again.
+ *
+ * Pigeonhole-style formulas are just as hard. With --cardinality, cliques of
+ * binary clauses (!a !b) become at-most-one constraints kept natively: one
+ * list of k literals instead of k(k - 1) / 2 clauses, propagated directly and
+ * used in a counting argument. When more disjoint clauses over their literals
+ * need a true literal than the constraints covering them allow, the formula
+ * is refuted in polynomial time.
+ *
+ * A model of the simplified formula extends to the original one by undoing
+ * the eliminations newest first, making the witness literal true whenever an
+ * eliminated clause is false, and then reading substituted variables off
+ * their representatives.
+ */
+
+#define PREPROCESS_MAX_ROUNDS 8
+#define PROBE_MAX_STEPS 50000000LL       // Clause visits allowed across all probes
+#define ELIMINATE_MAX_STEPS 50000000LL   // Partner visits allowed for blocked and covered clauses
+#define COVERED_MAX_LITERALS 256         // Longest clause covered literal addition may build
+#define XOR_MAX_LENGTH 6                 // Longest XOR looked for, it takes 2^(k-1) clauses
+#define XOR_MAX_MATRIX_WORDS (1 << 23)   // Largest matrix (64 MB) Gaussian elimination runs on
+#define AMO_MIN_LENGTH 3                 // Fewest literals kept as a native at-most-one constraint
+
+// A clause on literal codes, rewritten in place as the formula simplifies
+typedef struct {
+    int *literals;
+    int length;      // -1 once the clause is satisfied or removed
+    int origin;      // Index of the input clause, -1 for derived clauses
+} CodedClause;
+
+// State of the preprocessor
+typedef struct {
+    CodedClause *clauses;
+    int num_clauses;
+    int capacity;
+    int num_codes;            // Twice the number of variables
+    int *substitute;          // Representative of every literal code
+    signed char *value;       // 1 true, -1 false, 0 unassigned, per literal code
+    int *trail;               // Literals assigned, top-level ones first
+    int trail_size;
+    int *occurs_start;        // Occurrence lists: clauses containing each literal code
+    int *occurs;
+    CodedClause *amos;        // At-most-one constraints taken over from cliques of binary clauses
+    int num_amos;
+    int amos_capacity;
+    int *amo_occurs_start;    // At-most-one constraints containing each literal code
+    int *amo_occurs;
+    long long steps;
+    bool contradiction;
+} Preprocessor;
+
+// Eliminations and substitutions needed to extend a model of the simplified formula
+typedef struct {
+    int *substitute;   // Representative of every literal code of the input
+    int *stack;        // Eliminated clauses: witness literal, other literals, then the length
+    int stack_size;
+    int stack_capacity;
+    int *xors;         // Dropped XOR rows: pivot variable, other variables, parity, then the length
+    int xors_size;
+    int xors_capacity;
+} Reconstruction;
+
+// Function to append a constraint of literal codes to an array of clauses or at-most-one constraints
+static bool push_constraint(CodedClause **array, int *size, int *capacity, int *literals, int length, int origin) {
+    if (*size >= *capacity) {
+        int new_capacity = *capacity > 0 ? *capacity * GROWTH_FACTOR : INITIAL_CAPACITY;
+        CodedClause *new_array = realloc(*array, new_capacity * sizeof(CodedClause));
+        if (!new_array) return false;
+        *array = new_array;
+        *capacity = new_capacity;
+    }
+    CodedClause *constraint = &(*array)[*size];
+    constraint->literals = malloc((length > 0 ? length : 1) * sizeof(int));
+    if (!constraint->literals) return false;
+    memcpy(constraint->literals, literals, length * sizeof(int));
+    constraint->length = length;
+    constraint->origin = origin;
+    (*size)++;
+    return true;
+}
+
+// Function to append a clause of literal codes to the preprocessor
+static bool push_coded_clause(Preprocessor *pre, int *literals, int length, int origin) {
+    return push_constraint(&pre->clauses, &pre->num_clauses, &pre->capacity, literals, length, origin);
+}
+
+// Function to make a literal true, returns false if it is already false
+static bool assign_literal(Preprocessor *pre, int code) {
+    if (pre->value[code] != 0) return pre->value[code] > 0;
+    pre->value[code] = 1;
+    pre->value[code ^ 1] = -1;
+    pre->trail[pre->trail_size++] = code;
+    return true;
+}
+
+// Function to map the clauses through the substitution and the top-level units
+// Removes false literals, duplicates, satisfied clauses and tautologies; new units are assigned
+static void rewrite_clauses(Preprocessor *pre, bool *new_units) {
+    *new_units = false;
+    for (int c = 0; c < pre->num_clauses && !pre->contradiction; c++) {
+        CodedClause *clause = &pre->clauses[c];
+        if (clause->length < 0) continue;
+        int length = 0;
+        bool satisfied = false;
+        for (int k = 0; k < clause->length && !satisfied; k++) {
+            int code = pre->substitute[clause->literals[k]];
+            if (pre->value[code] > 0) satisfied = true;
+            if (pre->value[code] != 0) continue;
+            bool seen = false;
+            for (int m = 0; m < length && !satisfied; m++) {
+                if (clause->literals[m] == (code ^ 1)) satisfied = true;
+                if (clause->literals[m] == code) seen = true;
+            }
+            if (!seen) clause->literals[length++] = code;
+        }
+        if (satisfied) {
+            clause->length = -1;
+        } else if (length == 0) {
+            pre->contradiction = true;
+        } else if (length == 1) {
+            assign_literal(pre, clause->literals[0]);
+            clause->length = -1;
+            *new_units = true;
+        } else {
+            clause->length = length;
+        }
+    }
+    
+    // An at-most-one constraint with a true literal makes the others false, a repeated literal must be false,
+    // and with both l and !l present every other literal is false
+    for (int a = 0; a < pre->num_amos && !pre->contradiction; a++) {
+        CodedClause *amo = &pre->amos[a];
+        if (amo->length < 0) continue;
+        int true_count = 0;
+        for (int k = 0; k < amo->length; k++) {
+            amo->literals[k] = pre->substitute[amo->literals[k]];
+            if (pre->value[amo->literals[k]] > 0) true_count++;
+        }
+        if (true_count > 1) {
+            pre->contradiction = true;
+            break;
+        }
+        // A constraint is dropped only once a pass settles it without assigning, so the next pass sees the clashes
+        int length = 0, pair = -1;
+        bool assigned = false;
+        for (int k = 0; k < amo->length; k++) {
+            int code = amo->literals[k];
+            if (true_count == 1 && pre->value[code] == 0) {
+                assign_literal(pre, code ^ 1);
+                assigned = true;
+            }
+            if (pre->value[code] < 0) continue;
+            for (int m = 0; m < length && pre->value[code] == 0; m++) {
+                if (amo->literals[m] == code) {
+                    assign_literal(pre, code ^ 1);
+                    assigned = true;
+                }
+                if (amo->literals[m] == (code ^ 1)) pair = code / 2;
+            }
+            amo->literals[length++] = code;
+        }
+        for (int k = 0; pair >= 0 && k < length; k++) {
+            if (amo->literals[k] / 2 != pair && pre->value[amo->literals[k]] == 0) {
+                assign_literal(pre, amo->literals[k] ^ 1);
+                assigned = true;
+            }
+        }
+        if (assigned) *new_units = true;
+        amo->length = (!assigned && (true_count == 1 || pair >= 0 || length < 2)) ? -1 : length;
+    }
+}
+
+// Function to build occurrence lists: for each literal code, the live constraints containing it
+static bool build_occurrence_lists(CodedClause *clauses, int num_clauses, int num_codes, int **start, int **list) {
+    free(*start);
+    free(*list);
+    *start = calloc(num_codes + 1, sizeof(int));
+    int total = 0;
+    for (int c = 0; c < num_clauses; c++) {
+        if (clauses[c].length > 0) total += clauses[c].length;
+    }
+    *list = malloc((total > 0 ? total : 1) * sizeof(int));
+    int *fill = malloc((num_codes > 0 ? num_codes : 1) * sizeof(int));
+    if (!*start || !*list || !fill) {
+        free(fill);
+        return false;
+    }
+    
+    for (int c = 0; c < num_clauses; c++) {
+        for (int k = 0; k < clauses[c].length; k++) (*start)[clauses[c].literals[k] + 1]++;
+    }
+    for (int code = 0; code < num_codes; code++) (*start)[code + 1] += (*start)[code];
+    memcpy(fill, *start, num_codes * sizeof(int));
+    for (int c = 0; c < num_clauses; c++) {
+        for (int k = 0; k < clauses[c].length; k++) (*list)[fill[clauses[c].literals[k]]++] = c;
+    }
+    free(fill);
+    return true;
+}
+
+// Function to build the occurrence lists of the live clauses and at-most-one constraints
+static bool build_occurrences(Preprocessor *pre) {
+    return build_occurrence_lists(pre->clauses, pre->num_clauses, pre->num_codes, &pre->occurs_start, &pre->occurs) &&
+           build_occurrence_lists(pre->amos, pre->num_amos, pre->num_codes, &pre->amo_occurs_start, &pre->amo_occurs);
+}
+
+// Function to propagate the assignments on the trail from position next
+// Returns false on a conflict; with root >= 0, literals forced by longer clauses give (!root m)
+static bool propagate_literals(Preprocessor *pre, int next, int root, int *hyper_binary, int max_hyper_binary) {
+    for (; next < pre->trail_size; next++) {
+        int true_code = pre->trail[next];
+        for (int o = pre->amo_occurs_start[true_code]; o < pre->amo_occurs_start[true_code + 1]; o++) {
+            CodedClause *amo = &pre->amos[pre->amo_occurs[o]];
+            pre->steps++;
+            for (int k = 0; k < amo->length; k++) {
+                if (amo->literals[k] == true_code) continue;
+                if (pre->value[amo->literals[k]] > 0) return false;
+                assign_literal(pre, amo->literals[k] ^ 1);
+            }
+        }
+        
+        int false_code = true_code ^ 1;
+        for (int o = pre->occurs_start[false_code]; o < pre->occurs_start[false_code + 1]; o++) {
+            CodedClause *clause = &pre->clauses[pre->occurs[o]];
+            int unassigned = 0, last = -1;
+            bool satisfied = false;
+            pre->steps++;
+            for (int k = 0; k < clause->length && !satisfied; k++) {
+                int code = clause->literals[k];
+                if (pre->value[code] > 0) satisfied = true;
+                if (pre->value[code] == 0) {
+                    unassigned++;
+                    last = code;
+                }
+            }
+            if (satisfied || unassigned > 1) continue;
+            if (unassigned == 0) return false;
+            
+            assign_literal(pre, last);
+            if (root < 0) continue;
+            if (clause->length > 2 && *hyper_binary < max_hyper_binary) {
+                // The resolvent is optional, so running out of memory only drops it
+                int resolvent[2] = {root ^ 1, last};
+                if (push_coded_clause(pre, resolvent, 2, -1)) (*hyper_binary)++;
+            }
+        }
+    }
+    return true;
+}
+
+// Function to undo the assignments made after the trail had the given size
+static void backtrack(Preprocessor *pre, int size) {
+    while (pre->trail_size > size) {
+        int code = pre->trail[--pre->trail_size];
+        pre->value[code] = 0;
+        pre->value[code ^ 1] = 0;
+    }
+}
+
+// Function to propagate the top-level units until every clause is rewritten against them
+// Returns false when memory runs out; a conflict sets pre->contradiction
+static bool propagate_units(Preprocessor *pre) {
+    bool new_units;
+    do {
+        rewrite_clauses(pre, &new_units);
+        if (new_units && !pre->contradiction) {
+            if (!build_occurrences(pre)) return false;
+            if (!propagate_literals(pre, 0, -1, NULL, 0)) pre->contradiction = true;
+        }
+    } while (new_units && !pre->contradiction);
+    return true;
+}
+
+// Function to find the strongly connected components of the binary implication graph
+// Composes the substitution with the smallest literal of each component, returns the literals merged or -1
+static int substitute_equivalences(Preprocessor *pre) {
+    int n = pre->num_codes;
+    int *edge_start = calloc(n + 1, sizeof(int));
+    int *index = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *low = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *stack = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *calls = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *positions = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *rep = malloc((n > 0 ? n : 1) * sizeof(int));
+    char *on_stack = calloc(n > 0 ? n : 1, 1);
+    int num_edges = 0;
+    for (int c = 0; c < pre->num_clauses; c++) {
+        if (pre->clauses[c].length == 2) num_edges += 2;
+    }
+    int *edges = malloc((num_edges > 0 ? num_edges : 1) * sizeof(int));
+    if (!edge_start || !index || !low || !stack || !calls || !positions || !rep || !on_stack || !edges) {
+        free(edge_start); free(index); free(low); free(stack); free(calls);
+        free(positions); free(rep); free(on_stack); free(edges);
+        return -1;
+    }
+    
+    // The clause (a b) gives the implications !a -> b and !b -> a
+    for (int c = 0; c < pre->num_clauses; c++) {
+        if (pre->clauses[c].length != 2) continue;
+        edge_start[(pre->clauses[c].literals[0] ^ 1) + 1]++;
+        edge_start[(pre->clauses[c].literals[1] ^ 1) + 1]++;
+    }
+    for (int code = 0; code < n; code++) edge_start[code + 1] += edge_start[code];
+    memcpy(positions, edge_start, n * sizeof(int));
+    for (int c = 0; c < pre->num_clauses; c++) {
+        if (pre->clauses[c].length != 2) continue;
+        int a = pre->clauses[c].literals[0], b = pre->clauses[c].literals[1];
+        edges[positions[a ^ 1]++] = b;
+        edges[positions[b ^ 1]++] = a;
+    }
+    
+    // Iterative Tarjan: calls holds the DFS path, positions the next edge of each node on it
+    int counter = 0, stack_size = 0, merged = 0;
+    for (int code = 0; code < n; code++) {
+        index[code] = -1;
+        rep[code] = code;
+    }
+    for (int root = 0; root < n; root++) {
+        if (index[root] >= 0 || edge_start[root] == edge_start[root + 1]) continue;
+        int depth = 0;
+        calls[depth++] = root;
+        positions[root] = edge_start[root];
+        index[root] = low[root] = counter++;
+        stack[stack_size++] = root;
+        on_stack[root] = 1;
+        while (depth > 0) {
+            int v = calls[depth - 1];
+            if (positions[v] < edge_start[v + 1]) {
+                int w = edges[positions[v]++];
+                if (index[w] < 0) {
+                    index[w] = low[w] = counter++;
+                    stack[stack_size++] = w;
+                    on_stack[w] = 1;
+                    positions[w] = edge_start[w];
+                    calls[depth++] = w;
+                } else if (on_stack[w] && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+            if (low[v] == index[v]) {
+                int first = stack_size - 1;
+                while (stack[first] != v) first--;
+                int smallest = v;
+                for (int s = first; s < stack_size; s++) {
+                    if (stack[s] < smallest) smallest = stack[s];
+                }
+                for (int s = first; s < stack_size; s++) {
+                    rep[stack[s]] = smallest;
+                    on_stack[stack[s]] = 0;
+                    if (stack[s] != smallest) merged++;
+                }
+                stack_size = first;
+            }
+            depth--;
+            if (depth > 0 && low[v] < low[calls[depth - 1]]) low[calls[depth - 1]] = low[v];
+        }
+    }
+    
+    // A literal equivalent to its own negation makes the formula unsatisfiable
+    for (int code = 0; code < n; code += 2) {
+        if (rep[code] == rep[code + 1]) pre->contradiction = true;
+    }
+    for (int code = 0; code < n; code++) pre->substitute[code] = rep[pre->substitute[code]];
+    
+    free(edge_start); free(index); free(low); free(stack); free(calls);
+    free(positions); free(rep); free(on_stack); free(edges);
+    return merged;
+}
+
+// Function to probe every unassigned literal, learning the negation of failed ones
+// Returns false when the formula is found unsatisfiable or memory runs out
+static bool probe_literals(Preprocessor *pre, Budget *budget, SolverStats *stats, bool *changed) {
+    int max_hyper_binary = pre->num_clauses;
+    int hyper_binary = 0;
+    for (int code = 0; code < pre->num_codes && !pre->contradiction; code++) {
+        if (pre->value[code] != 0 || pre->substitute[code] != code ||
+            (pre->occurs_start[code ^ 1] == pre->occurs_start[(code ^ 1) + 1] &&
+             pre->amo_occurs_start[code] == pre->amo_occurs_start[code + 1])) {
+            continue;  // Assigned, substituted, or nothing to propagate into
+        }
+        if (pre->steps > PROBE_MAX_STEPS || budget_exhausted(budget, stats)) break;
+        
+        int level = pre->trail_size;
+        int clauses_before = pre->num_clauses;
+        assign_literal(pre, code);
+        bool consistent = propagate_literals(pre, level, code, &hyper_binary, max_hyper_binary);
+        backtrack(pre, level);
+        if (consistent) continue;
+        
+        // A failed literal: its resolvents are implied by the unit about to be learned
+        for (int c = clauses_before; c < pre->num_clauses; c++) free(pre->clauses[c].literals);
+        hyper_binary -= pre->num_clauses - clauses_before;
+        pre->num_clauses = clauses_before;
+        stats->failed_literals++;
+        *changed = true;
+        assign_literal(pre, code ^ 1);
+        if (!propagate_literals(pre, level, -1, NULL, 0)) pre->contradiction = true;
+    }
+    stats->hyper_binary += hyper_binary;
+    if (hyper_binary > 0) *changed = true;
+    return !pre->contradiction;
+}
+
+// Function to record an eliminated clause with its witness literal on the reconstruction stack
+static bool push_eliminated(Reconstruction *reconstruction, int *literals, int length, int witness) {
+    if (reconstruction->stack_size + length + 1 > reconstruction->stack_capacity) {
+        int new_capacity = reconstruction->stack_capacity > 0 ? reconstruction->stack_capacity : INITIAL_CAPACITY;
+        while (reconstruction->stack_size + length + 1 > new_capacity) new_capacity *= GROWTH_FACTOR;
+        int *new_stack = realloc(reconstruction->stack, new_capacity * sizeof(int));
+        if (!new_stack) return false;
+        reconstruction->stack = new_stack;
+        reconstruction->stack_capacity = new_capacity;
+    }
+    int *entry = &reconstruction->stack[reconstruction->stack_size];
+    entry[0] = witness;
+    int size = 1;
+    for (int k = 0; k < length; k++) {
+        if (literals[k] != witness) entry[size++] = literals[k];
+    }
+    entry[size] = size;
+    reconstruction->stack_size += size + 1;
+    return true;
+}
+
+// Function to compare two literals of the elimination queue: fewer resolution partners first
+static bool fewer_partners(int *count, int a, int b) {
+    return count[a ^ 1] < count[b ^ 1] || (count[a ^ 1] == count[b ^ 1] && a < b);
+}
+
+// Function to move a queued literal up or down until the heap is ordered again
+static void sift_literal(int *heap, int size, int *position, int *count, int index) {
+    int code = heap[index];
+    while (index > 0 && fewer_partners(count, code, heap[(index - 1) / 2])) {
+        heap[index] = heap[(index - 1) / 2];
+        position[heap[index]] = index;
+        index = (index - 1) / 2;
+    }
+    for (;;) {
+        int child = 2 * index + 1;
+        if (child >= size) break;
+        if (child + 1 < size && fewer_partners(count, heap[child + 1], heap[child])) child++;
+        if (!fewer_partners(count, heap[child], code)) break;
+        heap[index] = heap[child];
+        position[heap[index]] = index;
+        index = child;
+    }
+    heap[index] = code;
+    position[code] = index;
+}
+
+// Function to queue a literal, or reorder it when it is already queued
+static void queue_literal(int *heap, int *size, int *position, int *count, int code) {
+    if (position[code] < 0) {
+        heap[*size] = code;
+        position[code] = (*size)++;
+    }
+    sift_literal(heap, *size, position, count, position[code]);
+}
+
+// Function to check whether the clause in buffer (literals marked in mark) is blocked on l
+// With covered, the literals common to all non-tautological partners are added to buffer instead
+// Returns 1 if blocked, 0 if not, -1 if literals were added
+static int blocked_on(Preprocessor *pre, int c, int l, int *buffer, int *length, char *mark, char *in_partner,
+                      bool covered) {
+    int common_start = *length, common_end = *length;
+    bool first = true;
+    for (int o = pre->occurs_start[l ^ 1]; o < pre->occurs_start[(l ^ 1) + 1]; o++) {
+        CodedClause *partner = &pre->clauses[pre->occurs[o]];
+        if (partner->length <= 0 || pre->occurs[o] == c) continue;
+        pre->steps++;
+        bool tautology = false;
+        for (int k = 0; k < partner->length && !tautology; k++) {
+            if (partner->literals[k] != (l ^ 1) && mark[partner->literals[k] ^ 1]) tautology = true;
+        }
+        if (tautology) continue;
+        if (!covered) return 0;
+        
+        // Keep the partner literals not in the clause yet, then intersect with each later partner
+        if (first) {
+            for (int k = 0; k < partner->length && common_end < COVERED_MAX_LITERALS; k++) {
+                int code = partner->literals[k];
+                if (code != (l ^ 1) && !mark[code]) buffer[common_end++] = code;
+            }
+            first = false;
+        } else {
+            for (int k = 0; k < partner->length; k++) in_partner[partner->literals[k]] = 1;
+            int kept = common_start;
+            for (int k = common_start; k < common_end; k++) {
+                if (in_partner[buffer[k]]) buffer[kept++] = buffer[k];
+            }
+            common_end = kept;
+            for (int k = 0; k < partner->length; k++) in_partner[partner->literals[k]] = 0;
+        }
+        if (common_end == common_start) return 0;
+    }
+    if (first) return 1;
+    for (int k = common_start; k < common_end; k++) mark[buffer[k]] = 1;
+    *length = common_end;
+    return -1;
+}
+
+// Function to remove blocked clauses, and covered clauses when asked, recording them for model extension
+static bool eliminate_blocked(Preprocessor *pre, Reconstruction *reconstruction, bool covered, Budget *budget,
+                              SolverStats *stats) {
+    int n = pre->num_codes;
+    int *count = calloc(n + 1, sizeof(int));
+    int *heap = malloc((n + 1) * sizeof(int));
+    int *position = malloc((n + 1) * sizeof(int));
+    char *mark = calloc(n + 1, 1);
+    char *in_partner = calloc(n + 1, 1);
+    int *buffer = malloc(COVERED_MAX_LITERALS * sizeof(int));
+    int *steps = malloc(COVERED_MAX_LITERALS * 2 * sizeof(int));  // Clause length and witness of each addition
+    char *in_amo = calloc(n / 2 + 1, 1);
+    bool ok = count && heap && position && mark && in_partner && buffer && steps && in_amo;
+    int heap_size = 0;
+    long long step_limit = pre->steps + ELIMINATE_MAX_STEPS;
+    
+    // Flipping a witness must not break an at-most-one constraint, so their variables never serve as witnesses
+    for (int a = 0; ok && a < pre->num_amos; a++) {
+        for (int k = 0; k < pre->amos[a].length; k++) in_amo[pre->amos[a].literals[k] / 2] = 1;
+    }
+    for (int code = 0; ok && code < n; code++) {
+        count[code] = pre->occurs_start[code + 1] - pre->occurs_start[code];
+        position[code] = -1;
+    }
+    for (int code = 0; ok && code < n; code++) {
+        if (count[code] > 0) queue_literal(heap, &heap_size, position, count, code);
+    }
+    
+    while (ok && heap_size > 0 && pre->steps < step_limit && !budget_exhausted(budget, stats)) {
+        int l = heap[0];
+        position[l] = -1;
+        if (--heap_size > 0) {
+            heap[0] = heap[heap_size];
+            sift_literal(heap, heap_size, position, count, 0);
+        }
+        
+        for (int o = pre->occurs_start[l]; ok && o < pre->occurs_start[l + 1]; o++) {
+            int c = pre->occurs[o];
+            CodedClause *clause = &pre->clauses[c];
+            if (clause->length <= 0 || clause->length > COVERED_MAX_LITERALS) continue;
+            
+            int length = clause->length, num_steps = 0, result = 0, witness = l;
+            memcpy(buffer, clause->literals, length * sizeof(int));
+            for (int k = 0; k < length; k++) mark[buffer[k]] = 1;
+            
+            // l first; with covered, then every literal of the clause as it grows
+            for (int k = -1; result != 1 && k < length && (covered || k < 0); k++) {
+                int candidate = k < 0 ? l : buffer[k];
+                if (in_amo[candidate / 2]) continue;
+                int before = length;
+                result = blocked_on(pre, c, candidate, buffer, &length, mark, in_partner, covered);
+                if (result == 1) {
+                    witness = candidate;
+                } else if (result == -1) {
+                    steps[2 * num_steps] = before;
+                    steps[2 * num_steps + 1] = candidate;
+                    num_steps++;
+                    if (length >= COVERED_MAX_LITERALS) break;
+                    k = -1;  // The added literals may leave earlier ones blocked
+                }
+            }
+            for (int k = 0; k < length; k++) mark[buffer[k]] = 0;
+            if (result != 1) continue;
+            
+            // Each addition step is undone as a blocked clause of its own, the clause itself first
+            for (int s = 0; ok && s < num_steps; s++) {
+                ok = push_eliminated(reconstruction, buffer, steps[2 * s], steps[2 * s + 1]);
+            }
+            if (ok) ok = push_eliminated(reconstruction, buffer, length, witness);
+            if (num_steps > 0) stats->covered++;
+            else stats->blocked++;
+            for (int k = 0; k < clause->length; k++) {
+                count[clause->literals[k]]--;
+                queue_literal(heap, &heap_size, position, count, clause->literals[k] ^ 1);
+            }
+            clause->length = -1;
+        }
+    }
+    
+    free(count);
+    free(heap);
+    free(position);
+    free(mark);
+    free(in_partner);
+    free(buffer);
+    free(steps);
+    free(in_amo);
+    return ok;
+}
+
+// Function to find the index of the lowest set bit of a non-zero word
+static int lowest_bit(uint64_t word) {
+    int bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+}
+
+// A clause that may belong to an XOR encoding, grouped with others over the same variables
+typedef struct {
+    uint64_t key;    // Hash of the sorted variables
+    int clause;
+    int signs;       // Bit i set when the literal on the i-th smallest variable is negated
+    int vars[XOR_MAX_LENGTH];
+} XorCandidate;
+
+// Function to order XOR candidates by their variable hash
+static int compare_xor_candidates(const void *a, const void *b) {
+    const XorCandidate *x = a, *y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return x->clause - y->clause;
+}
+
+// Function to add the clauses encoding vars[0] ^ ... ^ vars[length - 1] = parity
+// A clause rules out one assignment of the wrong parity, so it negates the variables that assignment sets
+static bool push_xor_clauses(Preprocessor *pre, int *vars, int length, int parity) {
+    int literals[XOR_MAX_LENGTH];
+    for (int signs = 0; signs < (1 << length); signs++) {
+        int negated = 0;
+        for (int k = 0; k < length; k++) negated ^= (signs >> k) & 1;
+        if (negated == parity) continue;
+        for (int k = 0; k < length; k++) literals[k] = 2 * vars[k] + ((signs >> k) & 1);
+        if (!push_coded_clause(pre, literals, length, -1)) return false;
+    }
+    return true;
+}
+
+// Function to record an XOR row solved for its pivot (vars[0]) for model extension
+static bool push_eliminated_xor(Reconstruction *reconstruction, int *vars, int length, int parity) {
+    if (reconstruction->xors_size + length + 2 > reconstruction->xors_capacity) {
+        int new_capacity = reconstruction->xors_capacity > 0 ? reconstruction->xors_capacity : INITIAL_CAPACITY;
+        while (reconstruction->xors_size + length + 2 > new_capacity) new_capacity *= GROWTH_FACTOR;
+        int *new_xors = realloc(reconstruction->xors, new_capacity * sizeof(int));
+        if (!new_xors) return false;
+        reconstruction->xors = new_xors;
+        reconstruction->xors_capacity = new_capacity;
+    }
+    int *entry = &reconstruction->xors[reconstruction->xors_size];
+    memcpy(entry, vars, length * sizeof(int));
+    entry[length] = parity;
+    entry[length + 1] = length;
+    reconstruction->xors_size += length + 2;
+    return true;
+}
+
+// Function to list the variables of a reduced row, pivot first, returns their number
+static int read_xor_row(uint64_t *row, int words, int pivot, int *column_var, int *vars) {
+    int length = 0;
+    vars[length++] = column_var[pivot];
+    for (int w = 0; w < words; w++) {
+        for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+            int column = 64 * w + lowest_bit(bits);
+            if (column != pivot) vars[length++] = column_var[column];
+        }
+    }
+    return length;
+}
+
+// Function to replace XOR encodings by their Gauss-Jordan reduced form over GF(2)
+// Units and binaries from the reduced rows are added as clauses; rows whose pivot occurs nowhere
+// else are removed and solved during model extension. Rows too long to encode again keep the
+// original clauses.
+static bool eliminate_xors(Preprocessor *pre, Reconstruction *reconstruction, SolverStats *stats) {
+    int num_vars = pre->num_codes / 2;
+    int num_candidates = 0;
+    XorCandidate *candidates = malloc((pre->num_clauses > 0 ? pre->num_clauses : 1) * sizeof(XorCandidate));
+    if (!candidates) return false;
+    for (int c = 0; c < pre->num_clauses; c++) {
+        CodedClause *clause = &pre->clauses[c];
+        if (clause->length < 3 || clause->length > XOR_MAX_LENGTH) continue;
+        XorCandidate *candidate = &candidates[num_candidates++];
+        int sorted[XOR_MAX_LENGTH];
+        for (int k = 0; k < clause->length; k++) {
+            int m = k;
+            while (m > 0 && sorted[m - 1] > clause->literals[k]) {
+                sorted[m] = sorted[m - 1];
+                m--;
+            }
+            sorted[m] = clause->literals[k];
+        }
+        candidate->clause = c;
+        candidate->signs = 0;
+        candidate->key = (uint64_t)clause->length;
+        for (int k = 0; k < clause->length; k++) {
+            candidate->vars[k] = sorted[k] / 2;
+            candidate->signs |= (sorted[k] & 1) << k;
+            candidate->key = (candidate->key ^ (uint64_t)candidate->vars[k]) * 1099511628211ULL;
+        }
+    }
+    qsort(candidates, num_candidates, sizeof(XorCandidate), compare_xor_candidates);
+    
+    // An XOR is found where one parity has all 2^(k-1) sign patterns, so each row takes 4 clauses or more
+    int num_rows = 0, num_inputs = pre->num_clauses;
+    int *row_vars = malloc((num_candidates / 4 + 1) * XOR_MAX_LENGTH * sizeof(int));
+    int *row_length = malloc((num_candidates / 4 + 1) * sizeof(int));
+    int *row_parity = malloc((num_candidates / 4 + 1) * sizeof(int));
+    char *in_xor = calloc(num_inputs + 1, 1);
+    bool ok = row_vars && row_length && row_parity && in_xor;
+    for (int g = 0; ok && g < num_candidates;) {
+        int end = g + 1;
+        while (end < num_candidates && candidates[end].key == candidates[g].key) end++;
+        int length = pre->clauses[candidates[g].clause].length;
+        uint64_t seen = 0;
+        for (int i = g; i < end; i++) {
+            if (memcmp(candidates[i].vars, candidates[g].vars, length * sizeof(int)) == 0 &&
+                pre->clauses[candidates[i].clause].length == length) {
+                seen |= 1ULL << candidates[i].signs;
+            }
+        }
+        for (int negated = 0; negated < 2; negated++) {
+            int patterns = 0;
+            for (int signs = 0; signs < (1 << length); signs++) {
+                int parity = 0;
+                for (int k = 0; k < length; k++) parity ^= (signs >> k) & 1;
+                if (parity == negated && (seen >> signs) & 1) patterns++;
+            }
+            if (patterns < (1 << (length - 1))) continue;
+            
+            memcpy(&row_vars[num_rows * XOR_MAX_LENGTH], candidates[g].vars, length * sizeof(int));
+            row_length[num_rows] = length;
+            row_parity[num_rows] = 1 - negated;  // Clauses with an odd number of negations encode parity 0
+            num_rows++;
+            stats->xors++;
+            for (int i = g; i < end; i++) {
+                int parity = 0;
+                for (int k = 0; k < length; k++) parity ^= (candidates[i].signs >> k) & 1;
+                if (parity == negated && memcmp(candidates[i].vars, candidates[g].vars, length * sizeof(int)) == 0 &&
+                    pre->clauses[candidates[i].clause].length == length) {
+                    in_xor[candidates[i].clause] = 1;
+                }
+            }
+        }
+        g = end;
+    }
+    free(candidates);
+    
+    // Columns are the XOR variables; a pivot is best taken from those in no other clause
+    int *column_of = malloc((num_vars > 0 ? num_vars : 1) * sizeof(int));
+    int *column_var = malloc((num_vars > 0 ? num_vars : 1) * sizeof(int));
+    char *in_clause = calloc(num_vars > 0 ? num_vars : 1, 1);
+    ok = ok && column_of && column_var && in_clause;
+    int num_columns = 0;
+    for (int v = 0; ok && v < num_vars; v++) column_of[v] = -1;
+    for (int r = 0; ok && r < num_rows; r++) {
+        for (int k = 0; k < row_length[r]; k++) {
+            int v = row_vars[r * XOR_MAX_LENGTH + k];
+            if (column_of[v] < 0) {
+                column_var[num_columns] = v;
+                column_of[v] = num_columns++;
+            }
+        }
+    }
+    for (int c = 0; ok && c < pre->num_clauses; c++) {
+        if (in_xor[c]) continue;
+        for (int k = 0; k < pre->clauses[c].length; k++) in_clause[pre->clauses[c].literals[k] / 2] = 1;
+    }
+    int words = (num_columns + 63) / 64;
+    uint64_t *matrix = NULL, *private_mask = NULL;
+    char *parity = NULL;
+    if (ok && num_rows > 0 && (long long)num_rows * words <= XOR_MAX_MATRIX_WORDS) {
+        matrix = calloc((size_t)num_rows * words, sizeof(uint64_t));
+        private_mask = calloc(words, sizeof(uint64_t));
+        parity = malloc(num_rows);
+        ok = matrix && private_mask && parity;
+    }
+    
+    bool keep_clauses = false;
+    if (ok && matrix) {
+        for (int r = 0; r < num_rows; r++) {
+            for (int k = 0; k < row_length[r]; k++) {
+                int column = column_of[row_vars[r * XOR_MAX_LENGTH + k]];
+                matrix[(size_t)r * words + column / 64] |= 1ULL << (column % 64);
+            }
+            parity[r] = (char)row_parity[r];
+        }
+        for (int column = 0; column < num_columns; column++) {
+            if (!in_clause[column_var[column]]) private_mask[column / 64] |= 1ULL << (column % 64);
+        }
+        
+        // Gauss-Jordan: each row takes a pivot, which is then cleared from every other row a word at a time
+        int *pivot = malloc(num_rows * sizeof(int));
+        ok = pivot != NULL;
+        for (int r = 0; ok && r < num_rows; r++) {
+            uint64_t *row = &matrix[(size_t)r * words];
+            pivot[r] = -1;
+            for (int w = 0; w < words && pivot[r] < 0; w++) {
+                if (row[w] & private_mask[w]) pivot[r] = 64 * w + lowest_bit(row[w] & private_mask[w]);
+            }
+            for (int w = 0; w < words && pivot[r] < 0; w++) {
+                if (row[w]) pivot[r] = 64 * w + lowest_bit(row[w]);
+            }
+            if (pivot[r] < 0) {
+                if (parity[r]) pre->contradiction = true;  // 0 = 1
+                continue;
+            }
+            uint64_t bit = 1ULL << (pivot[r] % 64);
+            for (int other = 0; other < num_rows; other++) {
+                uint64_t *target = &matrix[(size_t)other * words];
+                if (other == r || !(target[pivot[r] / 64] & bit)) continue;
+                for (int w = 0; w < words; w++) target[w] ^= row[w];
+                parity[other] ^= parity[r];
+            }
+        }
+        
+        // A long row that can neither be dropped nor encoded again keeps the original clauses
+        int *vars = malloc((num_columns > 0 ? num_columns : 1) * sizeof(int));
+        ok = ok && vars;
+        for (int r = 0; ok && r < num_rows; r++) {
+            if (pivot[r] < 0) continue;
+            int length = read_xor_row(&matrix[(size_t)r * words], words, pivot[r], column_var, vars);
+            if (length > XOR_MAX_LENGTH && in_clause[vars[0]]) keep_clauses = true;
+        }
+        for (int r = 0; ok && !pre->contradiction && r < num_rows; r++) {
+            if (pivot[r] < 0) continue;
+            int length = read_xor_row(&matrix[(size_t)r * words], words, pivot[r], column_var, vars);
+            if (length <= 2) {
+                // Units and binaries are implied by the XORs, so they are added either way
+                ok = push_xor_clauses(pre, vars, length, parity[r]);
+                stats->xor_derived += length == 1 ? 1 : 2;
+            } else if (keep_clauses) {
+                continue;
+            } else if (!in_clause[vars[0]]) {
+                ok = push_eliminated_xor(reconstruction, vars, length, parity[r]);
+            } else {
+                ok = push_xor_clauses(pre, vars, length, parity[r]);
+            }
+        }
+        for (int c = 0; ok && !keep_clauses && c < num_inputs; c++) {
+            if (in_xor[c]) pre->clauses[c].length = -1;
+        }
+        free(vars);
+        free(pivot);
+    }
+    
+    free(row_vars);
+    free(row_length);
+    free(row_parity);
+    free(in_xor);
+    free(column_of);
+    free(column_var);
+    free(in_clause);
+    free(matrix);
+    free(private_mask);
+    free(parity);
+    return ok;
+}
+
+// Function to find the live binary clause (!a !b) among the sorted exclusion edges of a, returns its index or -1
+static int exclusion_clause(Preprocessor *pre, int *start, uint64_t *edges, int a, int b) {
+    int low = start[a], high = start[a + 1] - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        int neighbor = (int)(edges[middle] >> 32);
+        if (neighbor == b) {
+            int c = (int)(uint32_t)edges[middle];
+            return pre->clauses[c].length == 2 ? c : -1;
+        }
+        if (neighbor < b) low = middle + 1;
+        else high = middle - 1;
+    }
+    return -1;
+}
+
+// Function to replace cliques of binary clauses (!a !b) by native at-most-one constraints
+// A binary clause (x y) says at most one of !x and !y is true, so it is an edge between them,
+// and the cliques of that graph are grown greedily from the literals of highest degree
+static bool extract_at_most_one(Preprocessor *pre, SolverStats *stats) {
+    int n = pre->num_codes;
+    int *start = calloc(n + 2, sizeof(int));
+    int *members = malloc((n + 1) * sizeof(int));
+    uint64_t *order = malloc((n + 1) * sizeof(uint64_t));
+    bool ok = start && members && order;
+    int num_edges = 0;
+    
+    for (int c = 0; ok && c < pre->num_clauses; c++) {
+        CodedClause *clause = &pre->clauses[c];
+        if (clause->length != 2) continue;
+        start[(clause->literals[0] ^ 1) + 1]++;
+        start[(clause->literals[1] ^ 1) + 1]++;
+        num_edges += 2;
+    }
+    uint64_t *edges = ok ? malloc((num_edges + 1) * sizeof(uint64_t)) : NULL;
+    int *fill = ok ? malloc((n + 1) * sizeof(int)) : NULL;
+    ok = ok && edges && fill;
+    for (int code = 0; ok && code < n; code++) {
+        start[code + 1] += start[code];
+        fill[code] = start[code];
+    }
+    for (int c = 0; ok && c < pre->num_clauses; c++) {
+        CodedClause *clause = &pre->clauses[c];
+        if (clause->length != 2) continue;
+        int a = clause->literals[0] ^ 1, b = clause->literals[1] ^ 1;
+        edges[fill[a]++] = ((uint64_t)b << 32) | (uint32_t)c;
+        edges[fill[b]++] = ((uint64_t)a << 32) | (uint32_t)c;
+    }
+    
+    // Seeds by decreasing degree, each list sorted by neighbour for the adjacency test
+    for (int code = 0; ok && code < n; code++) {
+        qsort(&edges[start[code]], start[code + 1] - start[code], sizeof(uint64_t), compare_u64);
+        order[code] = ((uint64_t)(INT_MAX - (start[code + 1] - start[code])) << 32) | (uint32_t)code;
+    }
+    if (ok) qsort(order, n, sizeof(uint64_t), compare_u64);
+    
+    for (int i = 0; ok && i < n; i++) {
+        int seed = (int)(uint32_t)order[i];
+        if (start[seed + 1] - start[seed] < AMO_MIN_LENGTH - 1) break;
+        
+        // A neighbour joins when it is excluded with every member through a clause not used yet
+        int size = 1;
+        members[0] = seed;
+        for (int e = start[seed]; e < start[seed + 1]; e++) {
+            int candidate = (int)(edges[e] >> 32);
+            if (size > 1 && candidate == members[size - 1]) continue;  // Duplicate clause
+            bool joins = true;
+            for (int m = 0; joins && m < size; m++) {
+                joins = exclusion_clause(pre, start, edges, members[m], candidate) >= 0;
+            }
+            pre->steps += size;
+            if (joins) members[size++] = candidate;
+        }
+        if (size < AMO_MIN_LENGTH) continue;
+        
+        for (int m = 0; m < size; m++) {
+            for (int k = m + 1; k < size; k++) {
+                pre->clauses[exclusion_clause(pre, start, edges, members[m], members[k])].length = -1;
+            }
+        }
+        ok = push_constraint(&pre->amos, &pre->num_amos, &pre->amos_capacity, members, size, -1);
+        stats->at_most_one++;
+    }
+    
+    free(start);
+    free(members);
+    free(order);
+    free(edges);
+    free(fill);
+    return ok;
+}
+
+// Function to look for more clauses that need a true literal than at-most-one constraints can supply
+// Clauses whose literals all lie in at-most-one constraints are picked disjoint and greedily, each needs one true
+// literal of its own, and if fewer constraints cover all those literals than clauses were picked, the formula is
+// refuted: this settles pigeonhole-style formulas that resolution alone needs exponential time for
+static bool count_cardinality(Preprocessor *pre, SolverStats *stats) {
+    int n = pre->num_codes;
+    char *covered = calloc(n + 1, 1);
+    char *chosen = calloc(n + 1, 1);
+    char *used = calloc(pre->num_amos + 1, 1);
+    bool ok = covered && chosen && used;
+    int picked = 0, remaining = 0;
+    
+    for (int a = 0; ok && a < pre->num_amos; a++) {
+        for (int k = 0; k < pre->amos[a].length; k++) covered[pre->amos[a].literals[k]] = 1;
+    }
+    for (int c = 0; ok && c < pre->num_clauses; c++) {
+        CodedClause *clause = &pre->clauses[c];
+        if (clause->length <= 0) continue;
+        bool disjoint = true;
+        for (int k = 0; disjoint && k < clause->length; k++) {
+            disjoint = covered[clause->literals[k]] && !chosen[clause->literals[k]];
+        }
+        if (!disjoint) continue;
+        for (int k = 0; k < clause->length; k++) chosen[clause->literals[k]] = 3;
+        picked++;
+        remaining += clause->length;
+        
+        // An exactly-one constraint is a clause with the same literals as an at-most-one constraint
+        int first = clause->literals[0];
+        for (int o = pre->amo_occurs_start[first]; o < pre->amo_occurs_start[first + 1]; o++) {
+            CodedClause *amo = &pre->amos[pre->amo_occurs[o]];
+            bool same = amo->length == clause->length;
+            for (int k = 0; same && k < amo->length; k++) same = chosen[amo->literals[k]] == 3;
+            if (same) {
+                stats->exactly_one++;
+                break;
+            }
+        }
+        for (int k = 0; k < clause->length; k++) chosen[clause->literals[k]] = 1;
+    }
+    
+    // Cover the chosen literals by the constraint holding most of those left
+    int cover = 0;
+    while (ok && remaining > 0 && cover < picked) {
+        int best = -1, best_count = 0;
+        for (int a = 0; a < pre->num_amos; a++) {
+            if (used[a] || pre->amos[a].length < 0) continue;
+            int count = 0;
+            for (int k = 0; k < pre->amos[a].length; k++) count += chosen[pre->amos[a].literals[k]] == 1;
+            pre->steps += pre->amos[a].length;
+            if (count > best_count) {
+                best = a;
+                best_count = count;
+            }
+        }
+        if (best < 0) break;
+        used[best] = 1;
+        for (int k = 0; k < pre->amos[best].length; k++) {
+            if (chosen[pre->amos[best].literals[k]] == 1) chosen[pre->amos[best].literals[k]] = 2;
+        }
+        remaining -= best_count;
+        cover++;
+    }
+    if (ok && remaining == 0 && cover < picked) pre->contradiction = true;
+    
+    free(covered);
+    free(chosen);
+    free(used);
+    return ok;
+}
+
+// Function to free the preprocessor state
+static void free_preprocessor(Preprocessor *pre) {
+    for (int c = 0; c < pre->num_clauses; c++) free(pre->clauses[c].literals);
+    free(pre->clauses);
+    free(pre->value);
+    free(pre->trail);
+    free(pre->occurs_start);
+    free(pre->occurs);
+    for (int a = 0; a < pre->num_amos; a++) free(pre->amos[a].literals);
+    free(pre->amos);
+    free(pre->amo_occurs_start);
+    free(pre->amo_occurs);
+}
+
+// Function to add a clause of literal codes over the variables of formula to the simplified formula
+static bool add_coded_clause(Formula *formula, Formula *simplified, int *codes, int length) {
+    Clause clause;
+    if (!init_clause(&clause)) return false;
+    bool ok = true;
+    for (int k = 0; ok && k < length; k++) {
+        const char *name = formula->variables[codes[k] / 2].name;
+        ok = add_literal(&clause, name, codes[k] & 1) && find_or_add_variable(simplified, name) >= 0;
+    }
+    ok = ok && add_clause(simplified, &clause);
+    free_clause(&clause);
+    return ok;
+}
+
+// Function to add an at-most-one constraint over the variables of formula to the simplified formula
+// The resolution engine gets it back as pairwise clauses: auxiliary variables of a linear encoding only
+// give saturation more to resolve on, which costs far more than the extra binaries on satisfiable formulas
+static bool add_at_most_one(Formula *formula, Formula *simplified, int *codes, int length) {
+    bool ok = true;
+    for (int m = 0; ok && m < length; m++) {
+        for (int k = m + 1; ok && k < length; k++) {
+            int pair[2] = {codes[m] ^ 1, codes[k] ^ 1};
+            ok = add_coded_clause(formula, simplified, pair, 2);
+        }
+    }
+    return ok;
+}
+
+// Function to free the data kept for model extension
+void free_reconstruction(Reconstruction *reconstruction) {
+    free(reconstruction->substitute);
+    free(reconstruction->stack);
+    free(reconstruction->xors);
+    memset(reconstruction, 0, sizeof(*reconstruction));
+}
+
+// Function to simplify a formula by XOR elimination (with xor), at-most-one extraction (with cardinality),
+// equivalent-literal substitution, failed-literal probing and blocked (with covered, also covered) clause elimination
+// reconstruction receives what extend_model needs, search->goal_clauses is adjusted to the simplified formula
+bool preprocess(Formula *formula, Formula *simplified, Reconstruction *reconstruction, bool covered, bool xor_gauss,
+                bool cardinality, SearchOptions *search, Budget *budget, SolverStats *stats) {
+    Preprocessor pre;
+    memset(&pre, 0, sizeof(pre));
+    memset(reconstruction, 0, sizeof(*reconstruction));
+    pre.num_codes = 2 * formula->num_variables;
+    int *substitute = malloc((pre.num_codes + 1) * sizeof(int));
+    reconstruction->substitute = substitute;
+    pre.substitute = substitute;
+    pre.capacity = formula->num_clauses > 0 ? formula->num_clauses : INITIAL_CAPACITY;
+    pre.clauses = malloc(pre.capacity * sizeof(CodedClause));
+    pre.value = calloc(pre.num_codes + 1, 1);
+    pre.trail = malloc((pre.num_codes + 1) * sizeof(int));
+    bool ok = pre.clauses && pre.value && pre.trail && substitute;
+    double start = now_seconds();
+    
+    for (int code = 0; ok && code < pre.num_codes; code++) substitute[code] = code;
+    int *codes = malloc(INITIAL_CAPACITY * sizeof(int));
+    int codes_capacity = INITIAL_CAPACITY;
+    ok = ok && codes;
+    for (int c = 0; ok && c < formula->num_clauses; c++) {
+        Clause *clause = &formula->clauses[c];
+        if (clause->num_literals > codes_capacity) {
+            int *new_codes = realloc(codes, clause->num_literals * sizeof(int));
+            ok = new_codes != NULL;
+            if (!ok) break;
+            codes = new_codes;
+            codes_capacity = clause->num_literals;
+        }
+        for (int k = 0; k < clause->num_literals; k++) codes[k] = literal_code(formula, &clause->literals[k]);
+        ok = push_coded_clause(&pre, codes, clause->num_literals, c);
+    }
+    free(codes);
+    
+    TRACE_BEGIN("preprocess");
+    if (ok && xor_gauss) {
+        ok = propagate_units(&pre);
+        ok = ok && (pre.contradiction || eliminate_xors(&pre, reconstruction, stats));
+    }
+    if (ok && cardinality && !pre.contradiction) {
+        ok = propagate_units(&pre);
+        ok = ok && (pre.contradiction || extract_at_most_one(&pre, stats));
+    }
+    for (int round = 0; ok && !pre.contradiction && round < PREPROCESS_MAX_ROUNDS; round++) {
+        bool changed = false, new_units;
+        ok = propagate_units(&pre);
+        if (!ok || pre.contradiction) break;
+        
+        int merged = substitute_equivalences(&pre);
+        ok = merged >= 0;
+        if (merged > 0) {
+            stats->equivalences += merged / 2;  // Each merged variable shows up with both polarities
+            changed = true;
+            rewrite_clauses(&pre, &new_units);
+            if (new_units || pre.contradiction) continue;
+        }
+        if (!ok || pre.contradiction) break;
+        
+        ok = build_occurrences(&pre);
+        if (ok && !probe_literals(&pre, budget, stats, &changed)) break;
+        if (!changed || stats->stop_reason != STOP_NONE) break;
+    }
+    if (ok && !pre.contradiction) ok = propagate_units(&pre);  // Apply the last units and substitution
+    if (ok && !pre.contradiction && pre.num_amos > 0) {
+        ok = build_occurrences(&pre) && count_cardinality(&pre, stats);
+    }
+    if (ok && !pre.contradiction && stats->stop_reason == STOP_NONE) {
+        ok = build_occurrences(&pre) && eliminate_blocked(&pre, reconstruction, covered, budget, stats);
+    }
+    TRACE_END("preprocess");
+    
+    // Units first, then the surviving input clauses in order, then the derived clauses and at-most-one
+    // constraints, and last the surviving goal clauses, so that they are still the last clauses
+    ok = ok && init_formula(simplified);
+    int goal_first = search->goal_clauses > 0 ? formula->num_clauses - search->goal_clauses : formula->num_clauses;
+    if (goal_first < 0) goal_first = 0;
+    int goal_clauses = 0;
+    if (ok && pre.contradiction) {
+        // Any variable and its negation stand for the refuted formula
+        int contradiction[2] = {0, 1};
+        ok = add_coded_clause(formula, simplified, &contradiction[0], 1) &&
+             add_coded_clause(formula, simplified, &contradiction[1], 1);
+    } else {
+        for (int t = 0; ok && t < pre.trail_size; t++) {
+            ok = add_coded_clause(formula, simplified, &pre.trail[t], 1);
+        }
+        for (int derived = 0; derived < 2; derived++) {
+            for (int c = 0; ok && c < pre.num_clauses; c++) {
+                CodedClause *coded = &pre.clauses[c];
+                if (coded->length <= 0 || (coded->origin < 0) != derived || coded->origin >= goal_first) continue;
+                ok = add_coded_clause(formula, simplified, coded->literals, coded->length);
+            }
+        }
+        for (int a = 0; ok && a < pre.num_amos; a++) {
+            if (pre.amos[a].length < 0) continue;
+            ok = add_at_most_one(formula, simplified, pre.amos[a].literals, pre.amos[a].length);
+        }
+        for (int c = 0; ok && c < pre.num_clauses; c++) {
+            CodedClause *coded = &pre.clauses[c];
+            if (coded->length <= 0 || coded->origin < goal_first) continue;
+            ok = add_coded_clause(formula, simplified, coded->literals, coded->length);
+            goal_clauses++;
+        }
+    }
+    
+    // Preprocessing may leave no goal clause, by satisfying it, making it a unit or removing it as
+    // blocked; the set of support then falls back to the default goal, which is complete
+    if (search->goal_clauses > 0) search->goal_clauses = goal_clauses;
+    stats->preprocess_time = now_seconds() - start;
+    
+    free_preprocessor(&pre);
+    if (!ok) {
+        free_reconstruction(reconstruction);
+        printf("Error: Not enough memory to preprocess the formula\n");
+        return false;
+    }
+    return true;
+}
+
+// Function to extend a model of the simplified formula to the variables of the original one
+void extend_model(Formula *formula, Formula *simplified, Reconstruction *reconstruction, bool *simplified_model,
+                  bool *model) {
+    // A representative left in no clause can take either value
+    for (int v = 0; v < formula->num_variables; v++) {
+        int var = find_variable(simplified, formula->variables[v].name);
+        model[v] = var >= 0 ? simplified_model[var] : false;
+    }
+    
+    // Undo the eliminations newest first: a clause left false gets its witness made true
+    int *stack = reconstruction->stack;
+    for (int top = reconstruction->stack_size; top > 0;) {
+        int length = stack[top - 1];
+        int *literals = &stack[top - 1 - length];
+        top -= length + 1;
+        bool satisfied = false;
+        for (int k = 0; k < length && !satisfied; k++) {
+            satisfied = model[literals[k] / 2] != (literals[k] & 1);
+        }
+        if (!satisfied) model[literals[0] / 2] = !(literals[0] & 1);
+    }
+    
+    // Dropped XOR rows set their pivot, the other variables are read through the substitution
+    int *xors = reconstruction->xors;
+    for (int top = reconstruction->xors_size; top > 0;) {
+        int length = xors[top - 1];
+        int *vars = &xors[top - 2 - length];
+        bool value = xors[top - 2];
+        top -= length + 2;
+        for (int k = 1; k < length; k++) {
+            int code = reconstruction->substitute[2 * vars[k]];
+            value ^= model[code / 2] ^ (code & 1);
+        }
+        model[vars[0]] = value;
+    }
+    
+    for (int v = 0; v < formula->num_variables; v++) {
+        int code = reconstruction->substitute[2 * v];
+        if (code / 2 != v) model[v] = (code & 1) ? !model[code / 2] : model[code / 2];
+    }
+}
+
+/*
+ * Locality reordering
+ *
+ * The parser numbers variables in order of first appearance and keeps the
+ * clauses in file order, so clauses over the same variables can end up far
+ * apart, and so can the variables of one clause. With --reorder the formula is
+ * renumbered before solving. Variables are ranked by reverse Cuthill-McKee over
+ * the primal graph (variables sharing a clause are neighbours), never built
+ * explicitly: a breadth-first search from a variable of least degree reaches
+ * each unseen neighbour through the clauses it occurs in, and queues the
+ * neighbours of one variable fewest occurrences first. Each component starts
+ * from the far end of a first search, which keeps its levels narrow. The clauses
+ * are then sorted by their smallest variable, so neighbouring clauses share
+ * variables and every engine scanning occurrences or literal codes touches
+ * nearby memory. Variables keep their names, which is all the output needs.
+ */
+
+// Function to append the Cuthill-McKee order of the component of root to order, returns its new size
+// Variables and clauses are marked with stamp; keys is scratch space for one level of neighbours
+static int cuthill_mckee(CodedClause *clauses, int *occurs_start, int *occurs, int root, int stamp, int *var_mark,
+                         int *clause_mark, int *order, int size, uint64_t *keys) {
+    int head = size;
+    var_mark[root] = stamp;
+    order[size++] = root;
+    while (head < size) {
+        int v = order[head++], count = 0;
+        for (int code = 2 * v; code <= 2 * v + 1; code++) {
+            for (int o = occurs_start[code]; o < occurs_start[code + 1]; o++) {
+                int c = occurs[o];
+                if (clause_mark[c] == stamp) continue;  // Its variables were all queued already
+                clause_mark[c] = stamp;
+                for (int k = 0; k < clauses[c].length; k++) {
+                    int u = clauses[c].literals[k] / 2;
+                    if (var_mark[u] == stamp) continue;
+                    var_mark[u] = stamp;
+                    uint64_t degree = (uint64_t)(occurs_start[2 * u + 2] - occurs_start[2 * u]);
+                    keys[count++] = degree << 32 | (uint64_t)u;
+                }
+            }
+        }
+        qsort(keys, count, sizeof(uint64_t), compare_u64);
+        for (int k = 0; k < count; k++) order[size++] = (int)(keys[k] & 0xFFFFFFFF);
+    }
+    return size;
+}
+
+// Function to copy a formula with its variables in reverse Cuthill-McKee order and its clauses sorted
+// by smallest variable; the last search->goal_clauses clauses stay last. map receives the new id of
+// each variable of formula
+bool reorder_formula(Formula *formula, Formula *reordered, SearchOptions *search, int **map) {
+    int n = formula->num_variables, m = formula->num_clauses;
+    size_t num_codes = 0;
+    for (int c = 0; c < m; c++) num_codes += (size_t)formula->clauses[c].num_literals;
+    CodedClause *clauses = malloc((m > 0 ? m : 1) * sizeof(CodedClause));
+    int *codes = malloc((num_codes > 0 ? num_codes : 1) * sizeof(int));
+    int *occurs_start = NULL, *occurs = NULL;
+    int *by_degree = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *order = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *var_mark = calloc(n > 0 ? n : 1, sizeof(int));
+    int *clause_mark = calloc(m > 0 ? m : 1, sizeof(int));
+    uint64_t *keys = malloc(((size_t)(n > m ? n : m) + 1) * sizeof(uint64_t));
+    *map = malloc((n > 0 ? n : 1) * sizeof(int));
+    bool ok = clauses && codes && by_degree && order && var_mark && clause_mark && keys && *map;
+    
+    size_t used = 0;
+    for (int c = 0; ok && c < m; c++) {
+        Clause *clause = &formula->clauses[c];
+        clauses[c].literals = codes + used;
+        clauses[c].length = clause->num_literals;
+        clauses[c].origin = c;
+        for (int k = 0; k < clause->num_literals; k++) codes[used++] = literal_code(formula, &clause->literals[k]);
+    }
+    ok = ok && build_occurrence_lists(clauses, m, 2 * n, &occurs_start, &occurs);
+    
+    // Components start from their least frequent variable; isolated variables simply come last
+    if (ok) {
+        for (int v = 0; v < n; v++) {
+            keys[v] = (uint64_t)(occurs_start[2 * v + 2] - occurs_start[2 * v]) << 32 | (uint64_t)v;
+        }
+        qsort(keys, n, sizeof(uint64_t), compare_u64);
+        for (int v = 0; v < n; v++) by_degree[v] = (int)(keys[v] & 0xFFFFFFFF);
+    }
+    int size = 0, stamp = 0;
+    for (int next = 0; ok && next < n; next++) {
+        int root = by_degree[next];
+        if (var_mark[root] != 0) continue;
+        int end = cuthill_mckee(clauses, occurs_start, occurs, root, ++stamp, var_mark, clause_mark, order, size, keys);
+        cuthill_mckee(clauses, occurs_start, occurs, order[end - 1], ++stamp, var_mark, clause_mark, order, size, keys);
+        size = end;
+    }
+    
+    // Reversed, the order puts the far end of each search first
+    bool initialized = ok && init_formula(reordered);
+    ok = initialized;
+    for (int p = n - 1; ok && p >= 0; p--) {
+        int var = find_or_add_variable(reordered, formula->variables[order[p]].name);
+        ok = var >= 0;
+        if (ok) (*map)[order[p]] = var;
+    }
+    int goal_first = m - (search->goal_clauses < m ? search->goal_clauses : m);
+    for (int c = 0; ok && c < m; c++) {
+        int smallest = 0;
+        for (int k = 0; k < clauses[c].length; k++) {
+            int var = (*map)[clauses[c].literals[k] / 2];
+            if (k == 0 || var < smallest) smallest = var;
+        }
+        keys[c] = (uint64_t)(c >= goal_first) << 62 | (uint64_t)smallest << 31 | (uint64_t)c;
+    }
+    if (ok) qsort(keys, m, sizeof(uint64_t), compare_u64);
+    for (int s = 0; ok && s < m; s++) {
+        CodedClause *clause = &clauses[keys[s] & 0x7FFFFFFF];
+        ok = add_coded_clause(formula, reordered, clause->literals, clause->length);
+    }
+    
+    free(clauses);
+    free(codes);
+    free(occurs_start);
+    free(occurs);
+    free(by_degree);
+    free(order);
+    free(var_mark);
+    free(clause_mark);
+    free(keys);
+    if (!ok) {
+        if (initialized) free_formula(reordered);
+        free(*map);
+        *map = NULL;
+        printf("Error: Not enough memory to reorder the formula\n");
+    }
+    return ok;
+}
+
+/*
+ * Component decomposition
+ *
+ * Clauses that share no variable can never clash, so a formula whose variables
+ * fall into disjoint groups is solved one group at a time. Union-find over the
+ * variable table splits it after parsing; the components are then solved by a
+ * pool of threads. The formula is unsatisfiable as soon as one component is,
+ * and the models of satisfiable components combine into a model of the whole.
+ */
+
+#define MAX_SOLVER_THREADS 64
+
+// Function to find the representative of a variable, halving the path on the way
+static int find_root(int *parent, int var) {
+    while (parent[var] != var) {
+        parent[var] = parent[parent[var]];
+        var = parent[var];
+    }
+    return var;
+}
+
+// Function to split a formula into variable-disjoint components, returns their number or -1
+int split_components(Formula *formula, Formula **components) {
+    int *parent = malloc((formula->num_variables + 1) * sizeof(int));
+    int *component_of = malloc((formula->num_variables + 1) * sizeof(int));
+    if (!parent || !component_of) {
+        free(parent);
+        free(component_of);
+        return -1;
+    }
+    for (int v = 0; v < formula->num_variables; v++) parent[v] = v;
+    
+    for (int c = 0; c < formula->num_clauses; c++) {
+        Clause *clause = &formula->clauses[c];
+        int first = find_root(parent, find_variable(formula, clause->literals[0].var.name));
+        for (int k = 1; k < clause->num_literals; k++) {
+            int root = find_root(parent, find_variable(formula, clause->literals[k].var.name));
+            if (root != first) parent[root] = first;
+        }
+    }
+    
+    // Number the components in order of their first variable
+    int count = 0;
+    for (int v = 0; v < formula->num_variables; v++) component_of[v] = -1;
+    for (int v = 0; v < formula->num_variables; v++) {
+        int root = find_root(parent, v);
+        if (component_of[root] < 0) component_of[root] = count++;
+        component_of[v] = component_of[root];
+    }
+    
+    *components = malloc((count > 0 ? count : 1) * sizeof(Formula));
+    bool ok = *components != NULL;
+    int initialized = 0;
+    while (ok && initialized < count) {
+        ok = init_formula(&(*components)[initialized]);
+        if (ok) initialized++;
+    }
+    for (int c = 0; ok && c < formula->num_clauses; c++) {
+        Clause *clause = &formula->clauses[c];
+        Formula *component = &(*components)[component_of[find_variable(formula, clause->literals[0].var.name)]];
+        for (int k = 0; k < clause->num_literals && ok; k++) {
+            ok = find_or_add_variable(component, clause->literals[k].var.name) >= 0;
+        }
+        ok = ok && add_clause(component, clause);
+    }
+    
+    free(parent);
+    free(component_of);
+    if (!ok) {
+        for (int i = 0; i < initialized; i++) free_formula(&(*components)[i]);
+        free(*components);
+        *components = NULL;
+        return -1;
+    }
+    return count;
+}
+
+// Function to count the clauses among the last goal_clauses of the formula in each component
+static bool count_component_goals(Formula *formula, Formula *components, int count, int goal_clauses,
+                                  int *goals) {
+    int *component_of = malloc((formula->num_variables + 1) * sizeof(int));
+    if (!component_of) return false;
+    for (int c = 0; c < count; c++) {
+        for (int v = 0; v < components[c].num_variables; v++) {
+            component_of[find_variable(formula, components[c].variables[v].name)] = c;
+        }
+    }
+    int first = formula->num_clauses > goal_clauses ? formula->num_clauses - goal_clauses : 0;
+    for (int i = first; i < formula->num_clauses; i++) {
+        goals[component_of[find_variable(formula, formula->clauses[i].literals[0].var.name)]]++;
+    }
+    free(component_of);
+    return true;
+}
+
+// Work shared by the component solver threads
+typedef struct {
+    Formula *components;
+    int num_components;
+    SearchOptions *search;
+    int *goal_clauses;           // Goal clauses of each component, NULL for the default goal
+    Budget *budget;              // Copied by each thread, since checking it updates the progress clock
+    BudgetPool pool;             // The clause and memory limits hold for all components together
+    bool want_refutation;
+    volatile LONG next_component;
+    volatile LONG refuted;       // Set once a component is unsatisfiable, cancels the others
+    SolverResult *results;
+    SolverStats *stats;
+    Refutation *refutations;
+    bool **models;
+} ComponentJob;
+
+// Function run by each solver thread: claims components until none are left
+DWORD WINAPI component_worker(void *param) {
+    ComponentJob *job = param;
+    trace_thread_name("component solver");
+    for (;;) {
+        int c = (int)InterlockedIncrement(&job->next_component) - 1;
+        if (c >= job->num_components) break;
+        
+        SolverStats *stats = &job->stats[c];
+        job->results[c] = RESULT_UNKNOWN;
+        if (job->refuted) {
+            stats->stop_reason = STOP_CANCELLED;
+            continue;
+        }
+        // An explicit goal is a suffix of the formula, and so is its part in each component
+        SearchOptions search = *job->search;
+        if (job->goal_clauses) {
+            search.goal_clauses = job->goal_clauses[c];
+            if (search.goal_clauses == 0) {
+                stats->stop_reason = STOP_INCOMPLETE;  // Without goal clauses the set of support is empty
+                continue;
+            }
+        }
+        Budget budget = *job->budget;
+        budget.cancel = &job->refuted;
+        budget.pool = &job->pool;
+        budget.component = c;
+        job->models[c] = malloc((job->components[c].num_variables + 1) * sizeof(bool));
+        if (!job->models[c]) {
+            stats->stop_reason = STOP_OUT_OF_MEMORY;
+            continue;
+        }
+        
+        TRACE_BEGIN_ARG("component", c);
+        job->results[c] = resolution(&job->components[c], &search, &budget, stats,
+                                     job->want_refutation ? &job->refutations[c] : NULL, job->models[c]);
+        TRACE_END("component");
+        
+        // An answered component frees its working set; one stopped by a limit keeps its part of the
+        // pool, so the other components stop at the same totals the whole formula would
+        if (job->results[c] != RESULT_UNKNOWN) {
+            InterlockedExchangeAdd64(&job->pool.clauses, -budget.pooled_clauses);
+            InterlockedExchangeAdd64(&job->pool.memory, -budget.pooled_memory);
+        }
+        if (job->results[c] == RESULT_UNSATISFIABLE) InterlockedExchange(&job->refuted, 1);
+    }
+    return 0;
+}
+
+// Function to solve each component of a formula on a pool of threads
+// Same contract as resolution(); formulas with a single component are handed to it directly
+SolverResult solve_components(Formula *formula, SearchOptions *search, Budget *budget, SolverStats *stats,
+                              Refutation *refutation, bool *model, int threads) {
+    Formula *components;
+    TRACE_BEGIN("split");
+    int count = split_components(formula, &components);
+    TRACE_END("split");
+    if (count < 0) {
+        stats->stop_reason = STOP_OUT_OF_MEMORY;
+        return RESULT_UNKNOWN;
+    }
+    if (count <= 1) {
+        for (int i = 0; i < count; i++) free_formula(&components[i]);
+        free(components);
+        return resolution(formula, search, budget, stats, refutation, model);
+    }
+    
+    double start = now_seconds();
+    ComponentJob job;
+    memset(&job, 0, sizeof(job));
+    job.components = components;
+    job.num_components = count;
+    job.search = search;
+    job.goal_clauses = search->goal_clauses > 0 ? calloc(count, sizeof(int)) : NULL;
+    job.budget = budget;
+    job.want_refutation = refutation != NULL;
+    job.results = calloc(count, sizeof(SolverResult));
+    job.stats = calloc(count, sizeof(SolverStats));
+    job.refutations = calloc(count, sizeof(Refutation));
+    job.models = calloc(count, sizeof(bool *));
+    
+    SolverResult result = RESULT_UNKNOWN;
+    if (!job.results || !job.stats || !job.refutations || !job.models ||
+        (search->goal_clauses > 0 && !job.goal_clauses) ||
+        (job.goal_clauses && !count_component_goals(formula, components, count, search->goal_clauses,
+                                                    job.goal_clauses))) {
+        stats->stop_reason = STOP_OUT_OF_MEMORY;
+    } else {
+        if (threads > count) threads = count;
+        if (threads > MAX_SOLVER_THREADS) threads = MAX_SOLVER_THREADS;
+        HANDLE handles[MAX_SOLVER_THREADS];
+        int started = 0;
+        for (int t = 1; t < threads; t++) {
+            handles[started] = CreateThread(NULL, 0, component_worker, &job, 0, NULL);
+            if (handles[started]) started++;
+        }
+        component_worker(&job);  // The calling thread works too
+        if (started > 0) WaitForMultipleObjects(started, handles, TRUE, INFINITE);
+        for (int t = 0; t < started; t++) CloseHandle(handles[t]);
+        
+        // Combine: one refuted component refutes the formula, otherwise all must be satisfiable.
+        // A cancelled component holds no part of the answer, so its working set is not counted
+        int refuted = -1, unknown = -1;
+        for (int c = 0; c < count; c++) {
+            SolverStats *part = &job.stats[c];
+            stats->rounds = part->rounds > stats->rounds ? part->rounds : stats->rounds;
+            stats->given += part->given;
+            stats->pairs_tried += part->pairs_tried;
+            stats->clashes += part->clashes;
+            stats->tautologies += part->tautologies;
+            stats->duplicates += part->duplicates;
+            stats->kept += part->kept;
+            stats->too_wide += part->too_wide;
+            if (part->stop_reason != STOP_CANCELLED) {
+                stats->clauses += part->clauses;
+                stats->memory += part->memory;
+            }
+            if (part->max_clauses > stats->max_clauses) stats->max_clauses = part->max_clauses;
+            stats->spill_runs += part->spill_runs;
+            stats->spill_bytes += part->spill_bytes;
+            stats->setup_time += part->setup_time;
+            if (job.results[c] == RESULT_UNSATISFIABLE && refuted < 0) refuted = c;
+            if (job.results[c] == RESULT_UNKNOWN && part->stop_reason != STOP_CANCELLED && unknown < 0) unknown = c;
+        }
+        if (job.pool.peak_clauses > stats->max_clauses) stats->max_clauses = (int)job.pool.peak_clauses;
+        stats->variables = formula->num_variables;
+        stats->input_clauses = formula->num_clauses;
+        stats->saturation_time = now_seconds() - start;
+        
+        if (refuted >= 0) {
+            result = RESULT_UNSATISFIABLE;
+            if (refutation) {
+                *refutation = job.refutations[refuted];
+                job.refutations[refuted].clauses = NULL;
+                job.refutations[refuted].num_clauses = 0;
+            }
+        } else if (unknown >= 0) {
+            stats->stop_reason = job.stats[unknown].stop_reason;
+        } else {
+            result = RESULT_SATISFIABLE;
+            for (int c = 0; c < count && model; c++) {
+                for (int v = 0; v < components[c].num_variables; v++) {
+                    model[find_variable(formula, components[c].variables[v].name)] = job.models[c][v];
+                }
+            }
+        }
+    }
+    
+    for (int c = 0; c < count; c++) {
+        if (job.refutations) free_refutation(&job.refutations[c]);
+        if (job.models) free(job.models[c]);
+        free_formula(&components[c]);
+    }
+    free(components);
+    free(job.goal_clauses);
+    free(job.results);
+    free(job.stats);
+    free(job.refutations);
+    free(job.models);
+    return result;
+}
+
+/*
+ * Incremental solving
+ *
+ * A Solver keeps the interned variables, the clauses added so far and every
+ * resolvent derived from them between calls. None of these depend on the
+ * assumptions of a query, so each solve only resolves the pairs that involve
+ * clauses added since the previous call. Once the clause set is saturated, a
+ * query under assumptions a1 ... ak is answered by a scan: the clauses plus
+ * the assumptions are unsatisfiable exactly when some kept clause contains
+ * only literals from !a1 ... !ak.
+ */
+
+// State of an incremental solver
+typedef struct {
+    Formula formula;       // Interned variables and the clauses added by the caller
+    Clause *work_clauses;  // Added clauses followed by their resolvents
+    int work_size;
+    int work_capacity;
+    int processed;         // Every pair of work clauses below this index has been resolved
+    bool inconsistent;     // The empty clause follows from the added clauses alone
+    SolverResult last_result;
+    SolverStats stats;     // Accumulated over all calls
+} Solver;
+
+// Function to initialize an incremental solver
+bool solver_init(Solver *solver) {
+    memset(solver, 0, sizeof(*solver));
+    if (!init_formula(&solver->formula)) return false;
+    solver->work_clauses = malloc(INITIAL_CAPACITY * sizeof(Clause));
+    if (!solver->work_clauses) {
+        free_formula(&solver->formula);
+        return false;
+    }
+    solver->work_capacity = INITIAL_CAPACITY;
+    solver->stats.memory = solver->work_capacity * sizeof(Clause);
+    solver->last_result = RESULT_UNKNOWN;
+    return true;
+}
+
+// Function to free an incremental solver
+void solver_free(Solver *solver) {
+    for (int i = 0; i < solver->work_size; i++) {
+        free_clause(&solver->work_clauses[i]);
+    }
+    free(solver->work_clauses);
+    free_formula(&solver->formula);
+    solver->work_clauses = NULL;
+    solver->work_size = 0;
+    solver->work_capacity = 0;
+}
+
+// Function to add a clause to the solver, kept for all later calls
+bool solver_add_clause(Solver *solver, Clause *clause) {
+    if (is_tautology(clause)) return true;
+    if (is_empty_clause(clause)) {
+        solver->inconsistent = true;
+        return true;
+    }
+    for (int i = 0; i < clause->num_literals; i++) {
+        if (find_or_add_variable(&solver->formula, clause->literals[i].var.name) < 0) return false;
+    }
+    
+    // Clauses already known, as input or as resolvent, add nothing
+    for (int i = 0; i < solver->work_size; i++) {
+        if (clauses_equal(&solver->work_clauses[i], clause)) return true;
+    }
+    if (!add_clause(&solver->formula, clause)) return false;
+    
+    Clause copy;
+    if (!copy_clause(&copy, clause)) return false;
+    if (!push_work_clause(&solver->work_clauses, &solver->work_size, &solver->work_capacity, &copy,
+                          &solver->stats)) {
+        free_clause(&copy);
+        return false;
+    }
+    solver->stats.variables = solver->formula.num_variables;
+    solver->stats.input_clauses = solver->formula.num_clauses;
+    return true;
+}
+
+// Function to resolve the pairs not resolved by earlier calls, returns false if stopped by the budget
+static bool solver_saturate(Solver *solver, Budget *budget) {
+    SolverStats *stats = &solver->stats;
+    double saturation_start = now_seconds();
+    double saturation_before = stats->saturation_time;
+    stats->stop_reason = STOP_NONE;
+    TRACE_BEGIN("saturation");
+    
+    // Pairs (i, j) with i < j are resolved once, in the round where j is new
+    while (solver->processed < solver->work_size && !solver->inconsistent && stats->stop_reason == STOP_NONE) {
+        int end = solver->work_size;
+        TRACE_BEGIN_ARG("round", stats->rounds + 1);
+        
+        int j = solver->processed;
+        for (; j < end && !solver->inconsistent && stats->stop_reason == STOP_NONE; j++) {
+            for (int i = 0; i < j && !solver->inconsistent && stats->stop_reason == STOP_NONE; i++) {
+                if (++stats->pairs_tried % BUDGET_CHECK_INTERVAL == 0) {
+                    stats->saturation_time = saturation_before + now_seconds() - saturation_start;
+                    TRACE_COUNTER("clauses", solver->work_size);
+                    if (budget_exhausted(budget, stats)) break;
+                }
+                solver->inconsistent = resolve_pair(&solver->work_clauses, &solver->work_size,
+                                                    &solver->work_capacity, i, j, NULL, 0, budget, stats);
+            }
+            // Resume from a partly resolved clause by redoing it, resolvents are deduplicated
+            if (stats->stop_reason != STOP_NONE) break;
+            solver->processed = j + 1;
+        }
+        if (stats->stop_reason == STOP_NONE && !solver->inconsistent) {
+            stats->rounds++;
+        }
+        TRACE_COUNTER("clauses", solver->work_size);
+        TRACE_END("round");
+    }
+    stats->saturation_time = saturation_before + now_seconds() - saturation_start;
+    TRACE_END("saturation");
+    return stats->stop_reason == STOP_NONE;
+}
+
+// Function to check whether a kept clause contains only negations of the assumptions
+static bool refuted_by_assumptions(Solver *solver, char *assumed) {
+    for (int i = 0; i < solver->work_size; i++) {
+        Clause *clause = &solver->work_clauses[i];
+        bool refuted = true;
+        for (int k = 0; k < clause->num_literals && refuted; k++) {
+            int var = find_variable(&solver->formula, clause->literals[k].var.name);
+            // assumed[var] is 1 for an assumed positive literal and 2 for a negative one
+            refuted = assumed[var] == (clause->literals[k].is_negated ? 1 : 2);
+        }
+        if (refuted) return true;
+    }
+    return false;
+}
+
+// Function to solve the added clauses under assumption literals
+SolverResult solver_solve(Solver *solver, Literal *assumptions, int num_assumptions, Budget *budget) {
+    solver->last_result = RESULT_UNKNOWN;
+    if (solver->inconsistent) {
+        solver->last_result = RESULT_UNSATISFIABLE;
+        return solver->last_result;
+    }
+    
+    bool saturated = solver_saturate(solver, budget);
+    if (solver->inconsistent) {
+        solver->last_result = RESULT_UNSATISFIABLE;
+        return solver->last_result;
+    }
+    
+    char *assumed = calloc(solver->formula.num_variables + 1, 1);
+    if (!assumed) {
+        solver->stats.stop_reason = STOP_OUT_OF_MEMORY;
+        return solver->last_result;
+    }
+    bool contradictory = false;
+    for (int i = 0; i < num_assumptions && !contradictory; i++) {
+        int var = find_variable(&solver->formula, assumptions[i].var.name);
+        if (var < 0) continue;  // A variable no clause mentions cannot conflict
+        char mark = assumptions[i].is_negated ? 2 : 1;
+        contradictory = assumed[var] != 0 && assumed[var] != mark;
+        assumed[var] = mark;
+    }
+    
+    // A refutation found in a partial saturation is still a refutation
+    if (contradictory || refuted_by_assumptions(solver, assumed)) {
+        solver->last_result = RESULT_UNSATISFIABLE;
+    } else if (saturated) {
+        solver->last_result = RESULT_SATISFIABLE;
+    }
+    free(assumed);
+    return solver->last_result;
+}
+
+// Function to get the verdict of the last solve call
+SolverResult solver_result(Solver *solver) {
+    return solver->last_result;
+}
+
+// Function to parse whitespace separated literals (P or !P) into a new clause
+bool parse_literals(char *text, Clause *clause) {
+    if (!init_clause(clause)) return false;
+    
+    char *token = strtok(text, " \t");
+    while (token) {
+        bool is_negated = (token[0] == '!');
+        char *var_name = token + (is_negated ? 1 : 0);
+        
+        if (!is_valid_variable_name(var_name) || !add_literal(clause, var_name, is_negated)) {
+            free_clause(clause);
+            return false;
+        }
+        
+        token = strtok(NULL, " \t");
+    }
+    return true;
+}
+
+// Function to read a formula from a file
+bool read_formula_from_file(const char *filename, Formula *formula) {
+    TRACE_BEGIN("io:open");
+    FILE *file = fopen(filename, "r");
+    TRACE_END("io:open");
+    if (!file) {
+        printf("Error: Unable to open file %s\n", filename);
+        return false;
+    }
+    
+    if (!init_formula(formula)) {
+        printf("Error: Failed to initialize formula\n");
+        fclose(file);
+        return false;
+    }
+    
+    char line[MAX_LINE_LENGTH];
+    int line_num = 0;
+    
+    while (fgets(line, sizeof(line), file)) {
+        line_num++;
+        
+        // Remove trailing newline and whitespace
+        char *end = line + strlen(line) - 1;
+        while (end >= line && isspace(*end)) *end-- = '\0';
+        
+        // Skip empty lines and comments
+        if (line[0] == '\0' || line[0] == '#') continue;
+        
+        Clause clause;
+        if (!parse_literals(line, &clause)) {
+            free_formula(formula);
+            fclose(file);
+            return false;
+        }
+        
+        if (clause.num_literals > 0 && !is_tautology(&clause)) {
+            bool registered = true;
+            for (int i = 0; i < clause.num_literals && registered; i++) {
+                registered = find_or_add_variable(formula, clause.literals[i].var.name) >= 0;
+            }
+            if (!registered || !add_clause(formula, &clause)) {
+                free_clause(&clause);
+                free_formula(formula);
+                fclose(file);
+                return false;
+            }
+        }
+        free_clause(&clause);
+    }
+    
+    fclose(file);
+    return true;
+}
+
+// Function to write a formula to a file in the .cnf format read by read_formula_from_file
+bool write_formula_file(Formula *formula, const char *filename, const char *comment) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        printf("Error: Unable to create file %s\n", filename);
+        return false;
+    }
+    fprintf(file, "# %s\n", comment);
+    for (int i = 0; i < formula->num_clauses; i++) {
+        Clause *clause = &formula->clauses[i];
+        for (int k = 0; k < clause->num_literals; k++) {
+            fprintf(file, "%s%s%s", k ? " " : "", clause->literals[k].is_negated ? "!" : "",
+                    clause->literals[k].var.name);
+        }
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+// Function to answer a stream of queries against the formula with one incremental solver
+// Each line of the query file is "add <literals>" or "solve [assumption literals]"
+bool run_queries(Formula *formula, const char *filename, Budget *budget, SolverStats *stats) {
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        printf("Error: Unable to open file %s\n", filename);
+        return false;
+    }
+    
+    Solver solver;
+    if (!solver_init(&solver)) {
+        printf("Error: Failed to initialize solver\n");
+        fclose(file);
+        return false;
+    }
+    bool ok = true;
+    for (int i = 0; i < formula->num_clauses && ok; i++) {
+        ok = solver_add_clause(&solver, &formula->clauses[i]);
+    }
+    
+    char line[MAX_LINE_LENGTH];
+    int line_num = 0;
+    int queries = 0;
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_num++;
+        char *end = line + strlen(line) - 1;
+        while (end >= line && isspace(*end)) *end-- = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+        
+        bool is_add = strncmp(line, "add", 3) == 0 && (line[3] == ' ' || line[3] == '\t');
+        bool is_solve = strncmp(line, "solve", 5) == 0 && (line[5] == '\0' || line[5] == ' ' || line[5] == '\t');
+        Clause literals;
+        if ((!is_add && !is_solve) || !parse_literals(line + (is_add ? 3 : 5), &literals)) {
+            printf("Error: Invalid query on line %d of %s\n", line_num, filename);
+            ok = false;
+            break;
+        }
+        
+        if (is_add) {
+            ok = solver_add_clause(&solver, &literals);
+            if (!ok) printf("Error: Out of memory while adding line %d\n", line_num);
+        } else {
+            budget->start_time = GetTickCount64();
+            TRACE_BEGIN_ARG("query", queries + 1);
+            SolverResult result = solver_solve(&solver, literals.literals, literals.num_literals, budget);
+            TRACE_END("query");
+            queries++;
+            printf("%s\n", result_text(result));
+            if (result == RESULT_UNKNOWN) {
+                printf("Stopped: %s (%d clauses held)\n", stop_reason_text(solver.stats.stop_reason),
+                       solver.stats.clauses);
+            }
+        }
+        free_clause(&literals);
+    }
+    
+    // Report the accumulated counters, keeping the caller's parse time
+    double parse_time = stats->parse_time;
+    *stats = solver.stats;
+    stats->parse_time = parse_time;
+    solver_free(&solver);
+    fclose(file);
+    return ok;
+}
+
+// Function to read a number in the 7-bit variable-length encoding, returns false at end of file
+static bool proof_get_number(FILE *file, uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = getc(file);
+        if (byte == EOF) return false;
+        *value |= (uint64_t)(byte & 127) << shift;
+        if (!(byte & 128)) return true;
+    }
+    return false;
+}
+
+// Clause table of the proof checker, indexed by clause id
+typedef struct {
+    int **literals;          // Literals as 2 * variable + negated, NULL for unused or deleted ids
+    int *lengths;
+    int capacity;
+} CheckerClauses;
+
+// Function to store a clause under an id, taking ownership of the literal array
+static bool checker_store(CheckerClauses *table, uint64_t id, int *literals, int length) {
+    if (id >= (uint64_t)INT_MAX) return false;
+    if ((int)id >= table->capacity) {
+        int new_capacity = table->capacity > 0 ? table->capacity : INITIAL_CAPACITY;
+        while (new_capacity <= (int)id) new_capacity *= GROWTH_FACTOR;
+        int **new_literals = realloc(table->literals, new_capacity * sizeof(int *));
+        if (!new_literals) return false;
+        table->literals = new_literals;
+        int *new_lengths = realloc(table->lengths, new_capacity * sizeof(int));
+        if (!new_lengths) return false;
+        table->lengths = new_lengths;
+        for (int i = table->capacity; i < new_capacity; i++) {
+            table->literals[i] = NULL;
+            table->lengths[i] = 0;
+        }
+        table->capacity = new_capacity;
+    }
+    table->literals[id] = literals;
+    table->lengths[id] = length;
+    return true;
+}
+
+// Function to check a binary LRAT proof against the formula, in time linear in the proof size
+// Every added clause must follow by unit propagation over its hints, in the order given
+bool check_proof(Formula *formula, const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        printf("Error: Unable to open proof file %s\n", filename);
+        return false;
+    }
+    
+    CheckerClauses table = {NULL, NULL, 0};
+    int num_literals = 2 * (formula->num_variables + 1);
+    signed char *value = calloc(num_literals, 1);      // 1 true, -1 false, 0 unassigned
+    int *trail = malloc(num_literals * sizeof(int));
+    int *buffer = malloc(INITIAL_CAPACITY * sizeof(int));
+    int buffer_capacity = INITIAL_CAPACITY;
+    bool ok = value && trail && buffer;
+    if (!ok) printf("Error: Not enough memory to check the proof\n");
+    
+    // Input clause c gets id c + 1, as in the solver's working set
+    for (int c = 0; c < formula->num_clauses && ok; c++) {
+        Clause *clause = &formula->clauses[c];
+        int *literals = malloc((clause->num_literals > 0 ? clause->num_literals : 1) * sizeof(int));
+        ok = literals != NULL;
+        for (int k = 0; ok && k < clause->num_literals; k++) {
+            literals[k] = 2 * (find_variable(formula, clause->literals[k].var.name) + 1) +
+                          clause->literals[k].is_negated;
+        }
+        if (ok && !checker_store(&table, c + 1, literals, clause->num_literals)) {
+            free(literals);
+            ok = false;
+        }
+        if (!ok) printf("Error: Not enough memory to check the proof\n");
+    }
+    
+    long long step = 0;
+    uint64_t last_id = formula->num_clauses;
+    bool refuted = false;
+    int marker;
+    while (ok && !refuted && (marker = getc(file)) != EOF) {
+        step++;
+        uint64_t id, number;
+        if (marker == 'd') {
+            // Deletion: clause ids until 0
+            while ((ok = proof_get_number(file, &number)) && number != 0) {
+                id = number / 2;
+                if (id < (uint64_t)table.capacity) {
+                    free(table.literals[id]);
+                    table.literals[id] = NULL;
+                }
+            }
+            if (!ok) printf("Error: Proof step %lld is truncated\n", step);
+            continue;
+        }
+        if (marker != 'a' || !proof_get_number(file, &number) || number / 2 <= last_id) {
+            printf("Error: Proof step %lld is not an LRAT addition with a new id\n", step);
+            ok = false;
+            break;
+        }
+        id = number / 2;
+        last_id = id;
+        
+        // Read the literals and assign each of them false
+        int length = 0, assigned = 0;
+        bool conflict = false;
+        while ((ok = proof_get_number(file, &number)) && number != 0) {
+            if (number >= (uint64_t)num_literals || number < 2) {
+                printf("Error: Proof step %lld uses an unknown variable\n", step);
+                ok = false;
+                break;
+            }
+            if (length >= buffer_capacity) {
+                int *new_buffer = realloc(buffer, buffer_capacity * GROWTH_FACTOR * sizeof(int));
+                if (!new_buffer) {
+                    printf("Error: Not enough memory to check the proof\n");
+                    ok = false;
+                    break;
+                }
+                buffer = new_buffer;
+                buffer_capacity *= GROWTH_FACTOR;
+            }
+            int literal = (int)number;
+            buffer[length++] = literal;
+            if (value[literal] == 1) {
+                conflict = true;  // Contains a literal and its negation
+            } else if (value[literal] == 0) {
+                value[literal] = -1;
+                value[literal ^ 1] = 1;
+                trail[assigned++] = literal;
+            }
+        }
+        
+        // Each hint must become unit under the assignment, or falsified to end the check
+        while (ok && (ok = proof_get_number(file, &number)) && number != 0) {
+            if (conflict) continue;
+            uint64_t hint = number / 2;
+            if ((number & 1) || hint >= (uint64_t)table.capacity || !table.literals[hint]) {
+                printf("Error: Proof step %lld refers to a missing clause\n", step);
+                ok = false;
+                break;
+            }
+            int unassigned = -1, open = 0;
+            bool satisfied = false;
+            for (int k = 0; k < table.lengths[hint] && !satisfied; k++) {
+                int literal = table.literals[hint][k];
+                if (value[literal] == 1) {
+                    satisfied = true;
+                } else if (value[literal] == 0 && literal != unassigned) {
+                    unassigned = literal;
+                    open++;
+                }
+            }
+            if (satisfied || open > 1) {
+                printf("Error: Proof step %lld: hint %llu is not unit\n", step, (unsigned long long)hint);
+                ok = false;
+                break;
+            }
+            if (open == 0) {
+                conflict = true;
+            } else {
+                value[unassigned] = 1;
+                value[unassigned ^ 1] = -1;
+                trail[assigned++] = unassigned ^ 1;
+            }
+        }
+        for (int k = 0; k < assigned; k++) {
+            value[trail[k]] = 0;
+            value[trail[k] ^ 1] = 0;
+        }
+        if (!ok) {
+            if (feof(file)) printf("Error: Proof step %lld is truncated\n", step);
+            break;
+        }
+        if (!conflict) {
+            printf("Error: Proof step %lld does not follow from its hints\n", step);
+            ok = false;
+            break;
+        }
+        
+        int *literals = malloc((length > 0 ? length : 1) * sizeof(int));
+        if (!literals || !checker_store(&table, id, literals, length)) {
+            free(literals);
+            printf("Error: Not enough memory to check the proof\n");
+            ok = false;
+            break;
+        }
+        memcpy(literals, buffer, length * sizeof(int));
+        refuted = length == 0;
+    }
+    
+    if (ok && !refuted) {
+        printf("Error: The proof does not derive the empty clause\n");
+        ok = false;
+    }
+    for (int i = 0; i < table.capacity; i++) {
+        free(table.literals[i]);
+    }
+    free(table.literals);
+    free(table.lengths);
+    free(value);
+    free(trail);
+    free(buffer);
+    fclose(file);
+    return ok;
+}
+
+/*
+ * Renaming-invariant formula fingerprint
+ *
+ * The formula is viewed as a graph with one node per literal and one node per
+ * clause. Colour refinement (1-dimensional Weisfeiler-Leman) is run on it:
+ * clause colours absorb the multiset of their literal colours, literal colours
+ * absorb the multiset of their clause colours and the colour of their
+ * complement. Literal nodes start uncoloured, so the result ignores variable
+ * names and polarity. Cells that refinement cannot split are broken by
+ * individualising each member of the smallest cell and keeping the minimum
+ * resulting digest, equal digests ordered by the sorted colours they digest,
+ * which keeps the tie-break independent of node numbering.
+ */
+
+#define FINGERPRINT_MAX_ROUNDS 64
+#define FINGERPRINT_TIE_BREAK_LEVELS 8
+#define FINGERPRINT_TIE_BREAK_CELL 64
+
+typedef struct {
+    int num_literals;      // 2 * number of variables
+    int num_clauses;
+    int *clause_start;     // Clause i owns clause_lits[clause_start[i] .. clause_start[i+1])
+    int *clause_lits;
+    int *occ_start;        // Literal l occurs in occ_clauses[occ_start[l] .. occ_start[l+1])
+    int *occ_clauses;
+    uint64_t *colors;      // Literal colours followed by clause colours
+    uint64_t *next;
+    uint64_t *scratch;
+} FingerprintGraph;
+
+// Function to mix a 64-bit value (splitmix64 finaliser)
+uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static int compare_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static void free_fingerprint_graph(FingerprintGraph *g) {
+    free(g->clause_start);
+    free(g->clause_lits);
+    free(g->occ_start);
+    free(g->occ_clauses);
+    free(g->colors);
+    free(g->next);
+    free(g->scratch);
+}
+
+// Function to build the literal/clause incidence graph, dropping repeated literals
+static bool build_fingerprint_graph(Formula *formula, FingerprintGraph *g) {
+    int total = 0;
+    for (int i = 0; i < formula->num_clauses; i++) total += formula->clauses[i].num_literals;
+    
+    memset(g, 0, sizeof(*g));
+    g->num_literals = 2 * formula->num_variables;
+    g->num_clauses = formula->num_clauses;
+    int nodes = g->num_literals + g->num_clauses;
+    g->clause_start = malloc((g->num_clauses + 1) * sizeof(int));
+    g->clause_lits = malloc((total + 1) * sizeof(int));
+    g->occ_start = calloc(g->num_literals + 1, sizeof(int));
+    g->occ_clauses = malloc((total + 1) * sizeof(int));
+    g->colors = malloc((nodes + 1) * sizeof(uint64_t));
+    g->next = malloc((nodes + 1) * sizeof(uint64_t));
+    g->scratch = malloc((nodes + 1) * sizeof(uint64_t));
+    if (!g->clause_start || !g->clause_lits || !g->occ_start || !g->occ_clauses ||
+        !g->colors || !g->next || !g->scratch) {
+        free_fingerprint_graph(g);
+        return false;
+    }
+    
+    int pos = 0;
+    for (int i = 0; i < formula->num_clauses; i++) {
+        g->clause_start[i] = pos;
+        for (int k = 0; k < formula->clauses[i].num_literals; k++) {
+            g->clause_lits[pos++] = literal_code(formula, &formula->clauses[i].literals[k]);
+        }
+        qsort(g->clause_lits + g->clause_start[i], pos - g->clause_start[i], sizeof(int), compare_int);
+        int unique = g->clause_start[i];
+        for (int k = g->clause_start[i]; k < pos; k++) {
+            if (k == g->clause_start[i] || g->clause_lits[k] != g->clause_lits[unique - 1]) {
+                g->clause_lits[unique++] = g->clause_lits[k];
+            }
+        }
+        pos = unique;
+    }
+    g->clause_start[g->num_clauses] = pos;
+    
+    for (int k = 0; k < pos; k++) g->occ_start[g->clause_lits[k] + 1]++;
+    for (int l = 0; l < g->num_literals; l++) g->occ_start[l + 1] += g->occ_start[l];
+    int *fill = malloc((g->num_literals + 1) * sizeof(int));
+    if (!fill) {
+        free_fingerprint_graph(g);
+        return false;
+    }
+    memcpy(fill, g->occ_start, (g->num_literals + 1) * sizeof(int));
+    for (int i = 0; i < g->num_clauses; i++) {
+        for (int k = g->clause_start[i]; k < g->clause_start[i + 1]; k++) {
+            g->occ_clauses[fill[g->clause_lits[k]]++] = i;
+        }
+    }
+    free(fill);
+    
+    for (int l = 0; l < g->num_literals; l++) g->colors[l] = mix64(1);
+    for (int i = 0; i < g->num_clauses; i++) {
+        g->colors[g->num_literals + i] = mix64(2 + (uint64_t)(g->clause_start[i + 1] - g->clause_start[i]));
+    }
+    return true;
+}
+
+// Function to count the distinct colours of the graph
+static int count_colors(FingerprintGraph *g) {
+    int nodes = g->num_literals + g->num_clauses;
+    if (nodes == 0) return 0;
+    memcpy(g->scratch, g->colors, nodes * sizeof(uint64_t));
+    qsort(g->scratch, nodes, sizeof(uint64_t), compare_u64);
+    int count = 1;
+    for (int i = 1; i < nodes; i++) {
+        if (g->scratch[i] != g->scratch[i - 1]) count++;
+    }
+    return count;
+}
+
+// Function to refine the colouring until the number of cells stops growing, returns the rounds run
+static int refine_colors(FingerprintGraph *g) {
+    int cells = count_colors(g);
+    int round = 0;
+    while (round < FINGERPRINT_MAX_ROUNDS) {
+        round++;
+        for (int i = 0; i < g->num_clauses; i++) {
+            uint64_t sum = 0;
+            for (int k = g->clause_start[i]; k < g->clause_start[i + 1]; k++) {
+                sum += mix64(g->colors[g->clause_lits[k]]);
+            }
+            g->next[g->num_literals + i] = mix64(g->colors[g->num_literals + i] ^ mix64(sum));
+        }
+        for (int l = 0; l < g->num_literals; l++) {
+            uint64_t sum = 0;
+            for (int k = g->occ_start[l]; k < g->occ_start[l + 1]; k++) {
+                sum += mix64(g->colors[g->num_literals + g->occ_clauses[k]]);
+            }
+            g->next[l] = mix64(g->colors[l] ^ mix64(sum) ^ (mix64(g->colors[l ^ 1]) << 1));
+        }
+        uint64_t *tmp = g->colors;
+        g->colors = g->next;
+        g->next = tmp;
+        
+        int new_cells = count_colors(g);
+        if (new_cells == cells) break;
+        cells = new_cells;
+    }
+    return round;
+}
+
+// Function to digest the colour multiset into a single value
+static uint64_t digest_colors(FingerprintGraph *g, uint64_t seed) {
+    int nodes = g->num_literals + g->num_clauses;
+    memcpy(g->scratch, g->colors, nodes * sizeof(uint64_t));
+    qsort(g->scratch, nodes, sizeof(uint64_t), compare_u64);
+    uint64_t hash = mix64(seed ^ (uint64_t)nodes);
+    for (int i = 0; i < nodes; i++) {
+        hash = mix64(hash ^ g->scratch[i]);
+    }
+    return hash;
+}
+
+// Function to compare two sorted colour lists lexicographically
+static int compare_color_keys(const uint64_t *a, const uint64_t *b, int nodes) {
+    for (int i = 0; i < nodes; i++) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// Function to find the smallest non-singleton literal cell (ties broken by colour), returns its colour
+static bool find_target_cell(FingerprintGraph *g, uint64_t *cell_color, int *cell_size) {
+    memcpy(g->scratch, g->colors, g->num_literals * sizeof(uint64_t));
+    qsort(g->scratch, g->num_literals, sizeof(uint64_t), compare_u64);
+    bool found = false;
+    for (int i = 0; i < g->num_literals;) {
+        int j = i;
+        while (j < g->num_literals && g->scratch[j] == g->scratch[i]) j++;
+        if (j - i > 1 && (!found || j - i < *cell_size)) {
+            *cell_color = g->scratch[i];
+            *cell_size = j - i;
+            found = true;
+        }
+        i = j;
+    }
+    return found;
+}
+
+// Function to compute the 128-bit fingerprint of a formula
+bool formula_fingerprint(Formula *formula, uint64_t fingerprint[2]) {
+    FingerprintGraph g;
+    if (!build_fingerprint_graph(formula, &g)) return false;
+    
+    int nodes = g.num_literals + g.num_clauses;
+    uint64_t *saved = malloc((nodes + 1) * sizeof(uint64_t));
+    uint64_t *best = malloc((nodes + 1) * sizeof(uint64_t));
+    uint64_t *best_key = malloc((nodes + 1) * sizeof(uint64_t));
+    if (!saved || !best || !best_key) {
+        free(saved);
+        free(best);
+        free(best_key);
+        free_fingerprint_graph(&g);
+        return false;
+    }
+    
+    refine_colors(&g);
+    uint64_t trace = digest_colors(&g, 0);
+    
+    for (int level = 0; level < FINGERPRINT_TIE_BREAK_LEVELS; level++) {
+        uint64_t cell_color = 0;
+        int cell_size = 0;
+        if (!find_target_cell(&g, &cell_color, &cell_size) || cell_size > FINGERPRINT_TIE_BREAK_CELL) break;
+        
+        memcpy(saved, g.colors, nodes * sizeof(uint64_t));
+        uint64_t best_digest = 0;
+        bool have_best = false;
+        for (int l = 0; l < g.num_literals; l++) {
+            if (saved[l] != cell_color) continue;
+            memcpy(g.colors, saved, nodes * sizeof(uint64_t));
+            g.colors[l] = mix64(cell_color ^ 0x5EED5EED5EED5EEDULL);
+            refine_colors(&g);
+            // Equal digests are ordered by the sorted colours they digest (left in scratch), so the
+            // choice depends on the refined colouring alone and not on which literal came first
+            uint64_t digest = digest_colors(&g, level + 1);
+            int order = !have_best || digest != best_digest ? (digest < best_digest ? -1 : 1) :
+                        compare_color_keys(g.scratch, best_key, nodes);
+            if (!have_best || order < 0) {
+                best_digest = digest;
+                memcpy(best, g.colors, nodes * sizeof(uint64_t));
+                memcpy(best_key, g.scratch, nodes * sizeof(uint64_t));
+                have_best = true;
+            }
+        }
+        memcpy(g.colors, best, nodes * sizeof(uint64_t));
+        trace = mix64(trace ^ best_digest);
+    }
+    
+    fingerprint[0] = digest_colors(&g, trace);
+    fingerprint[1] = digest_colors(&g, mix64(trace));
+    
+    free(saved);
+    free(best);
+    free(best_key);
+    free_fingerprint_graph(&g);
+    return true;
+}
+
+/*
+ * Symmetry breaking
+ *
+ * Colourings and schedules are full of interchangeable colours and machines,
+ * and saturation then derives every symmetric copy of the same resolvents.
+ * The fingerprint graph doubles as the input of an automorphism search: a
+ * first path individualises one literal of the target cell per level until
+ * refinement leaves every literal in a cell of its own. Bottom-up, each other
+ * member of a first-path cell outside the orbit found so far is individualised
+ * instead and followed to a leaf with the same colour trace, a few leaves at
+ * most. A leaf pairs literals of equal colour with the first one; the pairing
+ * is kept as a generator only when it maps the clause set onto itself, so hash
+ * collisions cost symmetries but never soundness.
+ *
+ * Each generator gets the first SYMMETRY_LEX_PREFIX variables of its lex-leader
+ * constraint: with variables in index order, an assignment must not be larger
+ * than its image. Without auxiliary variables that takes 2^i clauses at level
+ * i, which keeps the added formula small. A satisfiable formula keeps at least
+ * its lexicographically smallest model of each orbit, so satisfiability is
+ * unchanged and every model found is a model of the input.
+ */
+
+#define SYMMETRY_MAX_GENERATORS 64
+#define SYMMETRY_MAX_LEAVES 16             // Leaves followed for each candidate image of a first-path literal
+#define SYMMETRY_MAX_PATH_WORDS (1 << 22)  // Colours kept for the first path and the search (2 x 32 MB)
+#define SYMMETRY_MAX_STEPS 20000000LL      // Node and edge visits allowed across all refinements
+#define SYMMETRY_LEX_PREFIX 3              // Variables of each generator the lex-leader clauses cover
+
+// A clause of the search graph keyed by the hash of its literal set
+typedef struct {
+    uint64_t hash;
+    int clause;
+} ClauseKey;
+
+// State of the automorphism search
+typedef struct {
+    FingerprintGraph g;
+    int nodes;
+    int depth;               // Levels of the first path
+    uint64_t *path;          // Colours before each first-path level, (depth + 1) * nodes
+    uint64_t *trial;         // Colours of the current search path
+    uint64_t *cell;          // Target cell colour at each level
+    uint64_t *digest;        // Colour digest after each level
+    int *chosen;             // Literal individualised at each first-path level
+    uint64_t *leaf_key;      // Literal colours of the first leaf, sorted
+    int *sigma;              // Candidate permutation of the literals
+    int *orbit;              // Union-find over literals joined by the generators found
+    ClauseKey *clause_keys;  // Clauses sorted by the hash of their literal set
+    int *buffer;
+    int **generators;
+    int num_generators;
+    int leaves;
+    long long steps;
+    Budget *budget;
+    SolverStats *stats;
+} SymmetrySearch;
+
+// Function to refine the colours of the search graph, counting the work done
+// A round visits every node and edge and sorts the colours to count the cells
+static void refine_symmetry(SymmetrySearch *s) {
+    int rounds = refine_colors(&s->g);
+    s->steps += (long long)(rounds + 1) * (2LL * s->nodes + 2LL * s->g.clause_start[s->g.num_clauses]);
+}
+
+// Function to hash a sorted literal set
+static uint64_t hash_literal_set(int *literals, int length) {
+    uint64_t hash = mix64((uint64_t)length);
+    for (int k = 0; k < length; k++) hash = mix64(hash ^ (uint64_t)literals[k]);
+    return hash;
+}
+
+// Function to order clause keys by hash
+static int compare_clause_keys(const void *a, const void *b) {
+    uint64_t x = ((const ClauseKey *)a)->hash, y = ((const ClauseKey *)b)->hash;
+    return (x > y) - (x < y);
+}
+
+// Function to check whether a sorted literal set is a clause of the search graph
+static bool has_clause(SymmetrySearch *s, int *literals, int length) {
+    uint64_t hash = hash_literal_set(literals, length);
+    int low = 0, high = s->g.num_clauses - 1;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (s->clause_keys[middle].hash < hash) low = middle + 1;
+        else high = middle;
+    }
+    for (int i = low; i < s->g.num_clauses && s->clause_keys[i].hash == hash; i++) {
+        int c = s->clause_keys[i].clause;
+        if (s->g.clause_start[c + 1] - s->g.clause_start[c] == length &&
+            memcmp(&s->g.clause_lits[s->g.clause_start[c]], literals, length * sizeof(int)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Function to read the permutation off a leaf and keep it when it is an automorphism of the formula
+static bool check_leaf(SymmetrySearch *s) {
+    int n = s->g.num_literals;
+    for (int l = 0; l < n; l++) s->sigma[l] = -1;
+    
+    // The literal of the first leaf with the same colour maps to l
+    for (int l = 0; l < n; l++) {
+        int low = 0, high = n - 1;
+        while (low < high) {
+            int middle = (low + high) / 2;
+            if (s->leaf_key[middle] < s->g.colors[l]) low = middle + 1;
+            else high = middle;
+        }
+        int first = s->chosen[s->depth + low];
+        if (s->leaf_key[low] != s->g.colors[l] || s->sigma[first] >= 0) return false;
+        s->sigma[first] = l;
+    }
+    
+    bool identity = true;
+    for (int l = 0; l < n; l++) {
+        if (s->sigma[l ^ 1] != (s->sigma[l] ^ 1)) return false;
+        identity = identity && s->sigma[l] == l;
+    }
+    if (identity) return false;
+    for (int c = 0; c < s->g.num_clauses; c++) {
+        int length = s->g.clause_start[c + 1] - s->g.clause_start[c];
+        for (int k = 0; k < length; k++) s->buffer[k] = s->sigma[s->g.clause_lits[s->g.clause_start[c] + k]];
+        qsort(s->buffer, length, sizeof(int), compare_int);
+        s->steps += length;
+        if (!has_clause(s, s->buffer, length)) return false;
+    }
+    
+    int *generator = malloc(n * sizeof(int));
+    if (!generator) return false;
+    memcpy(generator, s->sigma, n * sizeof(int));
+    s->generators[s->num_generators++] = generator;
+    for (int l = 0; l < n; l++) {
+        int a = find_root(s->orbit, l), b = find_root(s->orbit, s->sigma[l]);
+        if (a != b) s->orbit[a] = b;
+    }
+    return true;
+}
+
+// Function to follow every literal of the target cell at a level whose colours are in trial
+// Returns true once a leaf gave a generator
+static bool search_level(SymmetrySearch *s, int level) {
+    uint64_t *colors = &s->trial[(size_t)level * s->nodes];
+    if (level == s->depth) {
+        memcpy(s->g.colors, colors, s->nodes * sizeof(uint64_t));
+        s->leaves++;
+        return check_leaf(s);
+    }
+    for (int l = 0; l < s->g.num_literals; l++) {
+        if (colors[l] != s->cell[level]) continue;
+        if (s->leaves >= SYMMETRY_MAX_LEAVES || s->steps > SYMMETRY_MAX_STEPS) return false;
+        memcpy(s->g.colors, colors, s->nodes * sizeof(uint64_t));
+        s->g.colors[l] = mix64(s->cell[level] ^ 0x5EED5EED5EED5EEDULL);
+        refine_symmetry(s);
+        if (digest_colors(&s->g, level + 1) != s->digest[level + 1]) continue;
+        memcpy(&s->trial[(size_t)(level + 1) * s->nodes], s->g.colors, s->nodes * sizeof(uint64_t));
+        if (search_level(s, level + 1)) return true;
+    }
+    return false;
+}
+
+// Function to walk the first path and look for generators below each of its levels
+static bool find_generators(SymmetrySearch *s) {
+    int n = s->g.num_literals;
+    refine_symmetry(s);
+    s->digest[0] = digest_colors(&s->g, 0);
+    
+    // First path: the smallest literal of each target cell
+    for (s->depth = 0;; s->depth++) {
+        if ((size_t)(s->depth + 2) * s->nodes > SYMMETRY_MAX_PATH_WORDS || s->steps > SYMMETRY_MAX_STEPS) {
+            return true;  // Too deep to keep or too costly, give up without generators
+        }
+        memcpy(&s->path[(size_t)s->depth * s->nodes], s->g.colors, s->nodes * sizeof(uint64_t));
+        int cell_size = 0;
+        if (!find_target_cell(&s->g, &s->cell[s->depth], &cell_size)) break;
+        int chosen = 0;
+        while (s->g.colors[chosen] != s->cell[s->depth]) chosen++;
+        s->chosen[s->depth] = chosen;
+        s->g.colors[chosen] = mix64(s->cell[s->depth] ^ 0x5EED5EED5EED5EEDULL);
+        refine_symmetry(s);
+        s->digest[s->depth + 1] = digest_colors(&s->g, s->depth + 1);
+    }
+    
+    // Literals of the first leaf by colour; chosen[depth + i] is the literal of the i-th smallest colour
+    for (int l = 0; l < n; l++) s->leaf_key[l] = s->g.colors[l];
+    qsort(s->leaf_key, n, sizeof(uint64_t), compare_u64);
+    for (int l = 0; l < n; l++) {
+        int low = 0, high = n - 1;
+        while (low < high) {
+            int middle = (low + high) / 2;
+            if (s->leaf_key[middle] < s->g.colors[l]) low = middle + 1;
+            else high = middle;
+        }
+        s->chosen[s->depth + low] = l;
+    }
+    
+    for (int level = s->depth - 1; level >= 0; level--) {
+        uint64_t *colors = &s->path[(size_t)level * s->nodes];
+        int v = s->chosen[level];
+        for (int w = 0; w < n && s->num_generators < SYMMETRY_MAX_GENERATORS; w++) {
+            if (w == v || colors[w] != s->cell[level] || find_root(s->orbit, w) == find_root(s->orbit, v)) continue;
+            if (s->steps > SYMMETRY_MAX_STEPS || budget_exhausted(s->budget, s->stats)) return true;
+            memcpy(s->g.colors, colors, s->nodes * sizeof(uint64_t));
+            s->g.colors[w] = mix64(s->cell[level] ^ 0x5EED5EED5EED5EEDULL);
+            refine_symmetry(s);
+            if (digest_colors(&s->g, level + 1) != s->digest[level + 1]) continue;
+            memcpy(&s->trial[(size_t)(level + 1) * s->nodes], s->g.colors, s->nodes * sizeof(uint64_t));
+            s->leaves = 0;
+            search_level(s, level + 1);
+        }
+    }
+    return true;
+}
+
+// Function to add a clause of literal codes to a formula, unless it is a tautology
+static bool add_symmetry_clause(Formula *formula, int *codes, int length) {
+    for (int m = 0; m < length; m++) {
+        for (int k = m + 1; k < length; k++) {
+            if (codes[m] == (codes[k] ^ 1)) return true;
+        }
+    }
+    Clause clause;
+    if (!init_clause(&clause)) return false;
+    bool ok = true;
+    for (int k = 0; ok && k < length; k++) {
+        bool repeated = false;
+        for (int m = 0; m < k; m++) repeated = repeated || codes[m] == codes[k];
+        if (!repeated) ok = add_literal(&clause, formula->variables[codes[k] / 2].name, codes[k] & 1);
+    }
+    ok = ok && add_clause(formula, &clause);
+    free_clause(&clause);
+    return ok;
+}
+
+// Function to add the lex-leader clauses of a generator: x <= sigma(x) on the first variable it moves,
+// and on each later one as long as all earlier ones are equal
+static bool add_lex_leader(Formula *formula, int *sigma, SolverStats *stats) {
+    int support[SYMMETRY_LEX_PREFIX], length = 0;
+    for (int v = 0; v < formula->num_variables && length < SYMMETRY_LEX_PREFIX; v++) {
+        if (sigma[2 * v] == 2 * v) continue;
+        support[length++] = v;
+        if (sigma[2 * v] == 2 * v + 1) break;  // x <= !x leaves x false, so the rest never compares equal
+    }
+    
+    // Level i: for each j < i, !x_j or sigma(x_j) (x_j < sigma(x_j) holds), then !x_i or sigma(x_i)
+    int codes[SYMMETRY_LEX_PREFIX + 1];
+    for (int i = 0; i < length; i++) {
+        for (int mask = 0; mask < (1 << i); mask++) {
+            for (int j = 0; j < i; j++) {
+                codes[j] = (mask >> j) & 1 ? 2 * support[j] + 1 : sigma[2 * support[j]];
+            }
+            codes[i] = 2 * support[i] + 1;
+            codes[i + 1] = sigma[2 * support[i]];
+            int before = formula->num_clauses;
+            if (!add_symmetry_clause(formula, codes, i + 2)) return false;
+            stats->symmetry_clauses += formula->num_clauses - before;
+        }
+    }
+    return true;
+}
+
+// Function to add lex-leader symmetry-breaking clauses for the automorphisms found in the formula
+bool break_symmetries(Formula *formula, SearchOptions *search, Budget *budget, SolverStats *stats) {
+    SymmetrySearch s;
+    memset(&s, 0, sizeof(s));
+    double start = now_seconds();
+    if (!build_fingerprint_graph(formula, &s.g)) return false;
+    s.nodes = s.g.num_literals + s.g.num_clauses;
+    s.budget = budget;
+    s.stats = stats;
+    int n = s.g.num_literals;
+    size_t words = SYMMETRY_MAX_PATH_WORDS < (size_t)s.nodes * (n + 1) ? SYMMETRY_MAX_PATH_WORDS :
+                   (size_t)s.nodes * (n + 1);
+    int levels = (int)(words / (s.nodes > 0 ? s.nodes : 1)) + 1;
+    s.path = malloc(words * sizeof(uint64_t));
+    s.trial = malloc(words * sizeof(uint64_t));
+    s.cell = malloc(levels * sizeof(uint64_t));
+    s.digest = malloc((levels + 1) * sizeof(uint64_t));
+    s.chosen = malloc((levels + n + 1) * sizeof(int));
+    s.leaf_key = malloc((n + 1) * sizeof(uint64_t));
+    s.sigma = malloc((n + 1) * sizeof(int));
+    s.orbit = malloc((n + 1) * sizeof(int));
+    s.clause_keys = malloc((s.g.num_clauses + 1) * sizeof(ClauseKey));
+    s.buffer = malloc((n + 1) * sizeof(int));
+    s.generators = malloc(SYMMETRY_MAX_GENERATORS * sizeof(int *));
+    bool ok = s.path && s.trial && s.cell && s.digest && s.chosen && s.leaf_key && s.sigma && s.orbit &&
+              s.clause_keys && s.buffer && s.generators;
+    
+    if (ok) {
+        // Literals of unused variables stay fixed, they would only add pointless generators
+        for (int l = 0; l < n; l++) {
+            s.orbit[l] = l;
+            int var = l / 2;
+            if (s.g.occ_start[2 * var + 2] == s.g.occ_start[2 * var]) s.g.colors[l] = mix64(3 + (uint64_t)l);
+        }
+        for (int c = 0; c < s.g.num_clauses; c++) {
+            s.clause_keys[c].clause = c;
+            s.clause_keys[c].hash = hash_literal_set(&s.g.clause_lits[s.g.clause_start[c]],
+                                                     s.g.clause_start[c + 1] - s.g.clause_start[c]);
+        }
+        qsort(s.clause_keys, s.g.num_clauses, sizeof(ClauseKey), compare_clause_keys);
+        ok = find_generators(&s);
+    }
+    
+    // The new clauses join the goal clauses, so the clauses outside the set of support stay as they were
+    int first = formula->num_clauses;
+    for (int i = 0; ok && i < s.num_generators; i++) ok = add_lex_leader(formula, s.generators[i], stats);
+    if (search->goal_clauses > 0) search->goal_clauses += formula->num_clauses - first;
+    stats->symmetry_generators = s.num_generators;
+    stats->preprocess_time += now_seconds() - start;
+    
+    for (int i = 0; i < s.num_generators; i++) free(s.generators[i]);
+    free(s.generators);
+    free(s.path);
+    free(s.trial);
+    free(s.cell);
+    free(s.digest);
+    free(s.chosen);
+    free(s.leaf_key);
+    free(s.sigma);
+    free(s.orbit);
+    free(s.clause_keys);
+    free(s.buffer);
+    free_fingerprint_graph(&s.g);
+    return ok;
+}
+
+// Command line options of the solver
+typedef struct {
+    const char *filename;
+    bool fingerprint;      // Print the renaming-invariant fingerprint instead of solving
+    Budget budget;
+    bool stats;            // Print the statistics as JSON on stderr
+    const char *trace_file;  // Chrome trace output, NULL when tracing is off
+    const char *query_file;  // Query stream answered incrementally, NULL for a single solve
+    const char *proof_file;  // Binary proof output, NULL when proof logging is off
+    ProofFormat proof_format;
+    const char *check_file;  // LRAT proof to check instead of solving
+    const char *core_file;   // UNSAT core output (.cnf), NULL when not wanted
+    const char *trimmed_file;  // Proof of the core restricted to the steps it needs
+    bool minimize_core;    // Re-solve the core until it stops shrinking
+    SearchOptions search;
+    int threads;           // Component solver threads, 0 for one per processor
+    bool no_components;    // Solve the formula as a whole even when it splits
+    bool preprocess;       // Substitute equivalent literals, probe failed literals and remove blocked clauses first
+    bool covered;          // Also remove covered clauses when preprocessing
+    bool xor_gauss;        // Also recognise XOR constraints and reduce them by Gaussian elimination
+    bool cardinality;      // Also recognise at-most-one constraints and reason on them natively
+    bool symmetry;         // Add lex-leader clauses for the symmetries of the formula
+    const char *checkpoint_file;  // Snapshot of the saturation saved periodically, NULL when off
+    double checkpoint_interval;   // Seconds between two snapshots, 0 for the default
+    const char *resume_file;      // Snapshot to continue from, NULL for a fresh run
+    bool reorder;          // Renumber variables in Cuthill-McKee order and sort the clauses by them
+    const char *lemma_file;  // Store of short resolvents kept across runs, NULL when off
+} Options;
+
+// Function to print the command line usage
+void print_usage(const char *program) {
+    printf("Usage: %s [options] <filename>\n", program);
+    printf("Options:\n");
+    printf("  --fingerprint        Print a fingerprint invariant under variable renaming and polarity flips\n");
+    printf("  --timeout <sec>      Give up with UNKNOWN after this many seconds\n");
+    printf("  --max-memory <MB>    Give up with UNKNOWN when the clause set outgrows this size\n");
+    printf("  --max-clauses <n>    Give up with UNKNOWN when more than n clauses are held\n");
+    printf("  --stats              Print solver statistics as JSON on stderr\n");
+    printf("  --progress [sec]     Print statistics on stderr periodically (default every second)\n");
+    printf("  --trace <file>       Write a Chrome/Perfetto timeline of the solver phases to file\n");
+    printf("  --queries <file>     Answer \"add <clause>\" and \"solve [assumptions]\" lines incrementally\n");
+    printf("  --proof <file>       Stream every derived clause to file as a binary resolution proof\n");
+    printf("  --proof-format <f>   Proof format: lrat (default, with parent ids) or drat\n");
+    printf("  --check-proof <file> Check a binary LRAT proof of the formula instead of solving\n");
+    printf("  --core <file>        Write the input clauses used by the refutation to file (.cnf)\n");
+    printf("  --trimmed-proof <f>  Write the proof of the core, only the steps the refutation uses\n");
+    printf("  --minimize-core      Solve the core again until it stops shrinking (with --core or --trimmed-proof)\n");
+    printf("  --strategy <name>    saturate (default), unit, sos, ordered, zres or sls (local search)\n");
+    printf("  --goal-clauses <n>   Set of support: the last n clauses (default: the all-negative clauses)\n");
+    printf("  --max-width <k>      Discard resolvents wider than 1, 2, ... k literals; UNKNOWN if none refutes\n");
+    printf("  --threads <n>        Threads for independent components or sls searches (default: one per processor)\n");
+    printf("  --flips <n>          Local search: give up with UNKNOWN after n flips over all threads\n");
+    printf("  --seed <n>           Local search: seed of the random assignments and picks (default 0)\n");
+    printf("  --no-components      Do not split the formula into variable-disjoint components\n");
+    printf("  --preprocess         Substitute equivalent literals, probe failed literals and remove blocked clauses\n");
+    printf("  --covered            Also remove covered clauses when preprocessing (implies --preprocess)\n");
+    printf("  --xor                Also reduce XOR constraints by Gaussian elimination (implies --preprocess)\n");
+    printf("  --cardinality        Also reason on at-most-one constraints natively (implies --preprocess)\n");
+    printf("  --symmetry           Add lex-leader clauses that break the symmetries of the formula\n");
+    printf("  --reorder            Renumber variables in Cuthill-McKee order and sort the clauses for locality\n");
+    printf("  --spill <dir>        Keep waiting clauses on disk in sorted runs, shortest given first\n");
+    printf("  --checkpoint <file>  Save the saturation to file periodically so it can be resumed\n");
+    printf("  --checkpoint-interval <sec>\n");
+    printf("                       Seconds between two checkpoints (default 300)\n");
+    printf("  --resume <file>      Continue the saturation saved in file, checkpointing to it unless --checkpoint\n");
+    printf("  --lemmas <file>      Start from the stored lemmas that follow from the formula, then store new ones\n");
+}
+
+// Function to parse a non-negative number option value
+static bool parse_number(const char *text, double *value) {
+    char *end;
+    *value = strtod(text, &end);
+    return end != text && *end == '\0' && *value >= 0;
+}
+
+// Function to parse the command line, returns false on invalid usage
+bool parse_options(int argc, char *argv[], Options *options) {
+    memset(options, 0, sizeof(*options));
+    options->budget.component = -1;
+    for (int i = 1; i < argc; i++) {
+        double value;
+        if (strcmp(argv[i], "--fingerprint") == 0) {
+            options->fingerprint = true;
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            if (i + 1 >= argc) {
+                printf("Error: --trace expects a file name\n");
+                return false;
+            }
+            options->trace_file = argv[++i];
+        } else if (strcmp(argv[i], "--strategy") == 0) {
+            static const char *names[] = {"saturate", "unit", "sos", "ordered", "zres", "sls"};
+            int found = -1;
+            for (int k = 0; k < 6 && i + 1 < argc; k++) {
+                if (strcmp(argv[i + 1], names[k]) == 0) found = k;
+            }
+            if (found < 0) {
+                printf("Error: --strategy expects saturate, unit, sos, ordered, zres or sls\n");
+                return false;
+            }
+            options->search.strategy = (Strategy)found;
+            i++;
+        } else if (strcmp(argv[i], "--preprocess") == 0 || strcmp(argv[i], "--covered") == 0 ||
+                   strcmp(argv[i], "--xor") == 0 || strcmp(argv[i], "--cardinality") == 0) {
+            options->preprocess = true;
+            if (strcmp(argv[i], "--covered") == 0) options->covered = true;
+            if (strcmp(argv[i], "--xor") == 0) options->xor_gauss = true;
+            if (strcmp(argv[i], "--cardinality") == 0) options->cardinality = true;
+        } else if (strcmp(argv[i], "--symmetry") == 0) {
+            options->symmetry = true;
+        } else if (strcmp(argv[i], "--reorder") == 0) {
+            options->reorder = true;
+        } else if (strcmp(argv[i], "--spill") == 0) {
+            if (i + 1 >= argc) {
+                printf("Error: --spill expects a directory\n");
+                return false;
+            }
+            options->search.spill_dir = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint") == 0 || strcmp(argv[i], "--resume") == 0) {
+            if (i + 1 >= argc) {
+                printf("Error: %s expects a file name\n", argv[i]);
+                return false;
+            }
+            if (strcmp(argv[i], "--resume") == 0) {
+                options->resume_file = argv[++i];
+            } else {
+                options->checkpoint_file = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--lemmas") == 0) {
+            if (i + 1 >= argc) {
+                printf("Error: --lemmas expects a file name\n");
+                return false;
+            }
+            options->lemma_file = argv[++i];
+        } else if (strcmp(argv[i], "--no-components") == 0) {
+            options->no_components = true;
+        } else if (strcmp(argv[i], "--minimize-core") == 0) {
+            options->minimize_core = true;
+        } else if (strcmp(argv[i], "--queries") == 0 || strcmp(argv[i], "--proof") == 0 ||
+                   strcmp(argv[i], "--check-proof") == 0 || strcmp(argv[i], "--core") == 0 ||
+                   strcmp(argv[i], "--trimmed-proof") == 0) {
+            if (i + 1 >= argc) {
+                printf("Error: %s expects a file name\n", argv[i]);
+                return false;
+            }
+            if (strcmp(argv[i], "--queries") == 0) {
+                options->query_file = argv[i + 1];
+            } else if (strcmp(argv[i], "--proof") == 0) {
+                options->proof_file = argv[i + 1];
+            } else if (strcmp(argv[i], "--core") == 0) {
+                options->core_file = argv[i + 1];
+            } else if (strcmp(argv[i], "--trimmed-proof") == 0) {
+                options->trimmed_file = argv[i + 1];
+            } else {
+                options->check_file = argv[i + 1];
+            }
+            i++;
+        } else if (strcmp(argv[i], "--proof-format") == 0) {
+            if (i + 1 < argc && strcmp(argv[i + 1], "lrat") == 0) {
+                options->proof_format = PROOF_LRAT;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "drat") == 0) {
+                options->proof_format = PROOF_DRAT;
+            } else {
+                printf("Error: --proof-format expects lrat or drat\n");
+                return false;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            options->stats = true;
+        } else if (strcmp(argv[i], "--progress") == 0) {
+            options->budget.progress_interval = 1.0;
+            if (i + 1 < argc && parse_number(argv[i + 1], &value) && value > 0) {
+                options->budget.progress_interval = value;
+                i++;
+            }
+        } else if (strcmp(argv[i], "--timeout") == 0 || strcmp(argv[i], "--max-memory") == 0 ||
+                   strcmp(argv[i], "--max-clauses") == 0 || strcmp(argv[i], "--goal-clauses") == 0 ||
+                   strcmp(argv[i], "--max-width") == 0 || strcmp(argv[i], "--threads") == 0 ||
+                   strcmp(argv[i], "--flips") == 0 || strcmp(argv[i], "--seed") == 0 ||
+                   strcmp(argv[i], "--checkpoint-interval") == 0) {
+            if (i + 1 >= argc || !parse_number(argv[i + 1], &value)) {
+                printf("Error: %s expects a non-negative number\n", argv[i]);
+                return false;
+            }
+            if (strcmp(argv[i], "--timeout") == 0) {
+                options->budget.timeout = value;
+            } else if (strcmp(argv[i], "--max-memory") == 0) {
+                options->budget.max_memory = (size_t)(value * 1024 * 1024);
+            } else if (strcmp(argv[i], "--goal-clauses") == 0) {
+                options->search.goal_clauses = value > 2147483647.0 ? 2147483647 : (int)value;
+            } else if (strcmp(argv[i], "--max-width") == 0) {
+                options->search.max_width = value > 2147483647.0 ? 2147483647 : (int)value;
+            } else if (strcmp(argv[i], "--threads") == 0) {
+                options->threads = value > MAX_SOLVER_THREADS ? MAX_SOLVER_THREADS : (int)value;
+                options->search.threads = options->threads;
+            } else if (strcmp(argv[i], "--flips") == 0) {
+                options->search.max_flips = (long long)(value > 9e18 ? 9e18 : value);  // Chunks claimed past it stay in range
+            } else if (strcmp(argv[i], "--seed") == 0) {
+                options->search.seed = value > 4294967295.0 ? 4294967295u : (unsigned)value;
+            } else if (strcmp(argv[i], "--checkpoint-interval") == 0) {
+                options->checkpoint_interval = value;
+            } else {
+                options->budget.max_clauses = value > 2147483647.0 ? 2147483647 : (int)value;
+            }
+            i++;
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            printf("Error: Unknown option %s\n", argv[i]);
+            return false;
+        } else if (!options->filename) {
+            options->filename = argv[i];
+        } else {
+            return false;
+        }
+    }
+    if (options->proof_file && options->query_file) {
+        printf("Error: --proof cannot be combined with --queries\n");
+        return false;
+    }
+    if (options->minimize_core && !options->core_file && !options->trimmed_file) {
+        printf("Error: --minimize-core needs --core or --trimmed-proof\n");
+        return false;
+    }
+    if (options->preprocess && (options->proof_file || options->query_file || options->core_file ||
+                                options->trimmed_file)) {
+        // These refer to the input clauses, which preprocessing rewrites
+        printf("Error: --preprocess cannot be combined with --proof, --queries, --core or --trimmed-proof\n");
+        return false;
+    }
+    if (options->symmetry && (options->proof_file || options->query_file || options->core_file ||
+                              options->trimmed_file)) {
+        // Symmetry-breaking clauses are not implied by the input, so no proof or core may cite them
+        printf("Error: --symmetry cannot be combined with --proof, --queries, --core or --trimmed-proof\n");
+        return false;
+    }
+    if (options->reorder && (options->proof_file || options->query_file || options->trimmed_file)) {
+        // These number the input clauses and variables, which reordering permutes
+        printf("Error: --reorder cannot be combined with --proof, --queries or --trimmed-proof\n");
+        return false;
+    }
+    if (options->search.strategy == STRATEGY_ZRES && (options->proof_file || options->core_file ||
+                                                      options->trimmed_file || options->search.max_width > 0)) {
+        // The ZBDD keeps no individual clauses, so there are no parents to cite and no widths to bound
+        printf("Error: --strategy zres cannot be combined with --proof, --core, --trimmed-proof or --max-width\n");
+        return false;
+    }
+    if (options->search.strategy == STRATEGY_SLS &&
+        (options->proof_file || options->query_file || options->core_file || options->trimmed_file ||
+         options->search.max_width > 0 || options->search.spill_dir || options->checkpoint_file ||
+         options->resume_file || options->lemma_file)) {
+        // Local search derives no clauses: there is no refutation to prove and no working set to keep
+        printf("Error: --strategy sls cannot be combined with --proof, --queries, --core, --trimmed-proof, "
+               "--max-width, --spill, --checkpoint, --resume or --lemmas\n");
+        return false;
+    }
+    if (options->checkpoint_interval > 0 && !options->checkpoint_file && !options->resume_file) {
+        printf("Error: --checkpoint-interval only applies with --checkpoint or --resume\n");
+        return false;
+    }
+    if (options->search.strategy != STRATEGY_SLS && (options->search.max_flips > 0 || options->search.seed > 0)) {
+        printf("Error: --flips and --seed only apply to --strategy sls\n");
+        return false;
+    }
+    if (options->search.spill_dir &&
+        (options->proof_file || options->query_file || options->core_file || options->trimmed_file ||
+         options->search.max_width > 0 || options->search.strategy == STRATEGY_ORDERED ||
+         options->search.strategy == STRATEGY_ZRES)) {
+        // Spilled clauses carry no ids or parents, and the runs always give the shortest clause next
+        printf("Error: --spill cannot be combined with --proof, --queries, --core, --trimmed-proof, --max-width "
+               "or --strategy ordered/zres\n");
+        return false;
+    }
+    if ((options->checkpoint_file || options->resume_file) &&
+        (options->proof_file || options->query_file || options->search.spill_dir ||
+         options->search.strategy == STRATEGY_ZRES)) {
+        // A resumed run would miss the proof steps before the snapshot, and the other engines keep no working set
+        printf("Error: --checkpoint and --resume cannot be combined with --proof, --queries, --spill "
+               "or --strategy zres\n");
+        return false;
+    }
+    if (options->lemma_file &&
+        (options->proof_file || options->query_file || options->core_file || options->trimmed_file ||
+         options->checkpoint_file || options->resume_file || options->search.spill_dir ||
+         options->search.strategy == STRATEGY_ZRES)) {
+        // Imported lemmas enter without a derivation, so proofs and cores would cite clauses they cannot justify
+        printf("Error: --lemmas cannot be combined with --proof, --queries, --core, --trimmed-proof, --checkpoint, "
+               "--resume, --spill or --strategy zres\n");
+        return false;
+    }
+    return options->filename != NULL;
+}
+
+// Function to extract, optionally minimize, and write the UNSAT core and trimmed proof
+bool report_core(Formula *formula, Refutation *refutation, Options *options) {
+    Formula core;
+    TRACE_BEGIN("core");
+    if (!refutation_core(refutation, &core)) {
+        TRACE_END("core");
+        printf("Error: Not enough memory to extract the core\n");
+        return false;
+    }
+    int rounds = options->minimize_core ? minimize_core(&core, refutation, &options->search, &options->budget) : 0;
+    TRACE_END("core");
+    
+    bool ok = true;
+    printf("Core: %d of %d input clauses", core.num_clauses, formula->num_clauses);
+    if (options->minimize_core) printf(" after %d minimization round(s)", rounds);
+    printf("\n");
+    if (options->core_file) {
+        char comment[128];
+        snprintf(comment, sizeof(comment), "UNSAT core: %d of %d input clauses",
+                 core.num_clauses, formula->num_clauses);
+        ok = write_formula_file(&core, options->core_file, comment);
+    }
+    if (ok && options->trimmed_file) {
+        ok = write_trimmed_proof(refutation, &core, options->trimmed_file, options->proof_format);
+        if (!ok) printf("Error: Unable to write proof file %s\n", options->trimmed_file);
+    }
+    free_formula(&core);
+    return ok;
+}
+
+#ifndef LOGIC_SOLVER_NO_MAIN  // Defined by programs that include the solver, e.g. bench_kernels.c
+// Main function with improved formatting
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, &options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (options.search.spill_dir) {
+        DWORD attributes = GetFileAttributesA(options.search.spill_dir);
+        if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            printf("Error: Spill directory %s does not exist\n", options.search.spill_dir);
+            return 1;
+        }
+    }
+    
+    options.budget.start_time = GetTickCount64();
+    options.budget.last_progress = options.budget.start_time;
+    if (options.trace_file) {
+        trace_start();
+        trace_thread_name("main");
+    }
+    
+    SolverStats stats;
+    memset(&stats, 0, sizeof(stats));
+    double parse_start = now_seconds();
+    
+    Formula formula;
+    TRACE_BEGIN("parse");
+    bool parsed = read_formula_from_file(options.filename, &formula);
+    TRACE_END("parse");
+    if (!parsed) {
+        return 1;
+    }
+    stats.parse_time = now_seconds() - parse_start;
+    
+    if (options.fingerprint) {
+        uint64_t fingerprint[2];
+        TRACE_BEGIN("fingerprint");
+        bool computed = formula_fingerprint(&formula, fingerprint);
+        TRACE_END("fingerprint");
+        if (!computed) {
+            printf("Error: Not enough memory to fingerprint the formula\n");
+            free_formula(&formula);
+            return 1;
+        }
+        printf("%016llx%016llx\n", (unsigned long long)fingerprint[0], (unsigned long long)fingerprint[1]);
+        free_formula(&formula);
+        if (options.trace_file && !trace_close(options.trace_file)) {
+            printf("Error: Unable to write trace file %s\n", options.trace_file);
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (options.check_file) {
+        TRACE_BEGIN("check");
+        bool verified = check_proof(&formula, options.check_file);
+        TRACE_END("check");
+        printf("%s\n", verified ? "VERIFIED" : "NOT VERIFIED");
+        free_formula(&formula);
+        if (options.trace_file && !trace_close(options.trace_file)) {
+            printf("Error: Unable to write trace file %s\n", options.trace_file);
+            return 1;
+        }
+        return verified ? 0 : 1;
+    }
+    
+    if (options.query_file) {
+        bool answered = run_queries(&formula, options.query_file, &options.budget, &stats);
+        if (options.stats) {
+            fflush(stdout);
+            print_stats_json(stderr, &stats, answered ? "DONE" : "ERROR", -1);
+        }
+        free_formula(&formula);
+        if (options.trace_file && !trace_close(options.trace_file)) {
+            printf("Error: Unable to write trace file %s\n", options.trace_file);
+            return 1;
+        }
+        return answered ? 0 : 1;
+    }
+    
+    if (options.symmetry) {
+        TRACE_BEGIN("symmetry");
+        bool broken = break_symmetries(&formula, &options.search, &options.budget, &stats);
+        TRACE_END("symmetry");
+        if (!broken) {
+            printf("Error: Not enough memory to break the symmetries of the formula\n");
+            free_formula(&formula);
+            return 1;
+        }
+    }
+    
+    ProofWriter proof;
+    if (options.proof_file) {
+        if (!proof_open(&proof, options.proof_file, options.proof_format, &formula)) {
+            free_formula(&formula);
+            return 1;
+        }
+        proof_log = &proof;
+    }
+    Refutation refutation;
+    bool want_core = options.core_file || options.trimmed_file;
+    bool *model = malloc((formula.num_variables + 1) * sizeof(bool));
+    if (!model) {
+        printf("Error: Not enough memory for the model\n");
+        free_formula(&formula);
+        return 1;
+    }
+    
+    // With --preprocess the simplified formula is solved and its model extended to the input
+    Formula simplified;
+    Formula *solved = &formula;
+    bool *solved_model = model;
+    Reconstruction reconstruction;
+    if (options.preprocess) {
+        bool simplified_ok = preprocess(&formula, &simplified, &reconstruction, options.covered, options.xor_gauss,
+                                        options.cardinality, &options.search, &options.budget, &stats);
+        solved_model = simplified_ok ? malloc((simplified.num_variables + 1) * sizeof(bool)) : NULL;
+        if (!solved_model) {
+            if (simplified_ok) {
+                printf("Error: Not enough memory to preprocess the formula\n");
+                free_formula(&simplified);
+                free_reconstruction(&reconstruction);
+            }
+            free(model);
+            free_formula(&formula);
+            return 1;
+        }
+        solved = &simplified;
+    }
+    
+    // With --reorder the solved formula is renumbered for locality, and its model mapped back afterwards
+    Formula reordered;
+    int *reorder_map = NULL;  // Variable of the formula before reordering -> variable after
+    bool *unordered_model = solved_model;
+    if (options.reorder && stats.stop_reason == STOP_NONE) {
+        double reorder_start = now_seconds();
+        TRACE_BEGIN("reorder");
+        bool reordered_ok = reorder_formula(solved, &reordered, &options.search, &reorder_map);
+        TRACE_END("reorder");
+        solved_model = reordered_ok ? malloc((reordered.num_variables + 1) * sizeof(bool)) : NULL;
+        if (!solved_model) {
+            if (reordered_ok) {
+                printf("Error: Not enough memory to reorder the formula\n");
+                free(reorder_map);
+                free_formula(&reordered);
+            }
+            if (options.preprocess) {
+                free(unordered_model);
+                free_reconstruction(&reconstruction);
+                free_formula(&simplified);
+            }
+            free(model);
+            free_formula(&formula);
+            return 1;
+        }
+        solved = &reordered;
+        stats.preprocess_time += now_seconds() - reorder_start;
+    }
+    
+    // A resumed run goes on checkpointing into its snapshot unless told otherwise
+    Snapshot snapshot;
+    Checkpointer checkpointer;
+    const char *checkpoint_file = options.checkpoint_file ? options.checkpoint_file : options.resume_file;
+    LemmaStore lemmas;
+    bool checkpoints_ready = !options.resume_file || snapshot_load(&snapshot, options.resume_file, solved,
+                                                                   &options.search);
+    if (checkpoints_ready && checkpoint_file) {
+        checkpoints_ready = checkpoint_open(&checkpointer, checkpoint_file, options.checkpoint_interval, solved,
+                                            &options.search);
+        if (!checkpoints_ready && options.resume_file) snapshot_free(&snapshot);
+    }
+    if (checkpoints_ready && options.lemma_file) {
+        // Supports are matched against the clauses actually solved, after preprocessing and reordering
+        checkpoints_ready = lemma_open(&lemmas, options.lemma_file, solved);
+    }
+    if (!checkpoints_ready) {
+        if (reorder_map) {
+            free(solved_model);
+            free(reorder_map);
+            free_formula(&reordered);
+            solved_model = unordered_model;
+        }
+        if (options.preprocess) {
+            free(solved_model);
+            free_reconstruction(&reconstruction);
+            free_formula(&simplified);
+        }
+        free(model);
+        free_formula(&formula);
+        return 1;
+    }
+    if (options.resume_file) resume_snapshot = &snapshot;
+    if (checkpoint_file) checkpoint_log = &checkpointer;
+    if (options.lemma_file) lemma_store = &lemmas;
+    
+    SolverResult result = RESULT_UNKNOWN;
+    if (stats.stop_reason != STOP_NONE) {
+        // The budget ran out while preprocessing
+    } else if (options.no_components || options.proof_file || checkpoint_file || options.lemma_file ||
+               options.search.strategy == STRATEGY_SLS) {
+        // A streamed proof numbers clauses across the whole formula, a snapshot holds one working set,
+        // lemma supports are looked up among the clauses of the whole formula, and local search
+        // spreads its threads over restarts rather than components
+        result = resolution(solved, &options.search, &options.budget, &stats, want_core ? &refutation : NULL,
+                            solved_model);
+    } else {
+        if (options.threads <= 0) {
+            SYSTEM_INFO system_info;
+            GetSystemInfo(&system_info);
+            options.threads = (int)system_info.dwNumberOfProcessors;
+        }
+        result = solve_components(solved, &options.search, &options.budget, &stats,
+                                  want_core ? &refutation : NULL, solved_model, options.threads);
+    }
+    bool checkpoint_saved = true;
+    if (checkpoint_file) {
+        checkpoint_log = NULL;
+        resume_snapshot = NULL;
+        checkpoint_saved = checkpoint_close(&checkpointer);
+        if (options.resume_file) snapshot_free(&snapshot);
+        if (!checkpoint_saved) printf("Error: Unable to write checkpoint file %s\n", checkpoint_file);
+    }
+    bool lemmas_saved = true;
+    if (options.lemma_file) {
+        lemma_store = NULL;
+        lemmas_saved = lemma_close(&lemmas);
+        if (!lemmas_saved) printf("Error: Unable to write lemma file %s\n", options.lemma_file);
+    }
+    if (reorder_map) {
+        if (result == RESULT_SATISFIABLE) {
+            for (int v = 0; v < reordered.num_variables; v++) unordered_model[v] = solved_model[reorder_map[v]];
+        }
+        free(solved_model);
+        free(reorder_map);
+        free_formula(&reordered);
+        solved_model = unordered_model;
+    }
+    if (options.preprocess) {
+        if (result == RESULT_SATISFIABLE) extend_model(&formula, &simplified, &reconstruction, solved_model, model);
+        free(solved_model);
+        free_reconstruction(&reconstruction);
+        free_formula(&simplified);
+    }
+    if (options.proof_file) {
+        proof_log = NULL;
+        if (!proof_close(&proof)) {
+            printf("Error: Unable to write proof file %s\n", options.proof_file);
+            free(model);
+            free_formula(&formula);
+            return 1;
+        }
+    }
+    
+    bool model_checked = true;
+    if (result == RESULT_SATISFIABLE) {
+        printf("SATISFIABLE\n");
+        model_checked = verify_model(&formula, model);
+        if (model_checked) {
+            print_model(stdout, &formula, model);
+        } else {
+            printf("Error: The model does not satisfy the formula\n");
+        }
+    } else if (result == RESULT_UNSATISFIABLE) {
+        printf("UNSATISFIABLE\n");
+    } else {
+        printf("UNKNOWN\n");
+        if (stats.stop_reason == STOP_WIDTH_LIMIT) {
+            printf("No refutation of width <= %d (%lld wider resolvents discarded)\n",
+                   options.search.max_width, stats.too_wide);
+        }
+        bool given_loop = options.search.strategy == STRATEGY_UNIT || options.search.strategy == STRATEGY_SOS ||
+                          options.search.spill_dir;
+        if (options.search.strategy == STRATEGY_SLS) {
+            printf("Stopped: %s after %lld flips (%lld restarts, %d clauses)\n", stop_reason_text(stats.stop_reason),
+                   stats.flips, stats.restarts, stats.clauses);
+        } else if (options.search.strategy == STRATEGY_ZRES) {
+            // The ZBDD may hold more clauses than an int counts, or none yet when setup was stopped
+            printf("Stopped: %s after %d eliminated variables (", stop_reason_text(stats.stop_reason), stats.rounds);
+            if (stats.clauses > 0 && stats.clauses < INT_MAX) printf("%d clauses, ", stats.clauses);
+            printf("%.1f MB)\n", stats.memory / (1024.0 * 1024.0));
+        } else {
+            printf("Stopped: %s after %d %s (%d clauses, %.1f MB, %lld pairs tried)\n",
+                   stop_reason_text(stats.stop_reason), given_loop ? stats.given : stats.rounds,
+                   given_loop ? "given clauses" : "complete rounds",
+                   stats.clauses, stats.memory / (1024.0 * 1024.0), stats.pairs_tried);
+        }
+    }
+    bool core_written = true;
+    if (want_core && result == RESULT_UNSATISFIABLE) {
+        core_written = report_core(&formula, &refutation, &options);
+        free_refutation(&refutation);
+    }
+    if (options.stats) {
+        fflush(stdout);
+        TRACE_BEGIN("io:stats");
+        print_stats_json(stderr, &stats, result_text(result), -1);
+        TRACE_END("io:stats");
+    }
+    
+    free_formula(&formula);
+    if (options.trace_file && !trace_close(options.trace_file)) {
+        printf("Error: Unable to write trace file %s\n", options.trace_file);
+        return 1;
+    }
+    free(model);
+    if (!core_written || !model_checked || !checkpoint_saved || !lemmas_saved) return 1;
+    return result == RESULT_UNKNOWN ? EXIT_UNKNOWN : 0;
 }
+#endif